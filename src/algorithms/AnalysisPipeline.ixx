@@ -0,0 +1,304 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+export module AnalysisPipeline;
+
+import GraphConcepts;
+import ImplementedGraph;
+import AlgorithmResult;
+import GraphAlgo;
+import TaskScheduler;
+import Cancellation;
+import DegreeKernels;
+
+/**
+ * @brief Solves the four problems together, sharing the intermediate results between them.
+ *
+ * The intermediates (artifacts) are computed lazily, at most once per pipeline, by whichever problem needs them first:
+ *
+ *   in-degrees of the graph                    -> 1 source vertices (the graph keeps them, no artifact)
+ *   scc map                                    -> 2 diameter (more than one component means -1), 3 feedback arc set
+ *   scc map -> condensation -> topological order -> 4 first universal source
+ *
+ * run() starts the four problems as concurrent tasks on the task scheduler, so the sources are found while the scc
+ * map is built, and the diameter BFSs and the per component feedback arc set searches run in parallel.
+ * The graph must not change while the pipeline is in use.
+ *
+ * With a cancellation token the diameter and the feedback arc set give partial results like their strategies,
+ * sources and universal source (exact) come back as the string "cancelled". A cancelled artifact is not stored.
+ */
+export template <IsGraph GraphTypeImplementationGeneralizer = ImplementedGraph>
+class AnalysisPipeline {
+public:
+    struct Condensation {
+        std::vector<std::vector<int>> successors; // component -> distinct successor components
+        std::vector<int> in_degree;               // number of distinct predecessor components
+        std::vector<int> min_vertex;              // smallest vertex of every component
+        int num_sources = 0;
+    };
+
+    struct StageResult {
+        const char* name;
+        AlgoResultVariant result;
+        double elapsed_sec;
+    };
+
+private:
+    using Processor = GraphProcessor<GraphTypeImplementationGeneralizer>;
+    using FeedbackArcSet = std::vector<std::pair<int, int>>;
+
+    template <typename T>
+    struct Artifact {
+        std::once_flag once;
+        T value;
+    };
+
+    const GraphTypeImplementationGeneralizer& g;
+    Artifact<SccDecomposition> scc_artifact;
+    Artifact<Condensation> condensation_artifact;
+    Artifact<std::vector<int>> topological_order_artifact;
+    std::atomic<int> computed_artifacts{0};
+
+    // concurrent callers of an artifact that is being computed wait for it
+    template <typename T, typename Compute>
+    const T& get(Artifact<T>& artifact, Compute compute) {
+        std::call_once(artifact.once, [&] {
+            artifact.value = compute();
+            computed_artifacts.fetch_add(1, std::memory_order_relaxed);
+        });
+        return artifact.value;
+    }
+
+    Condensation compute_condensation(const CancellationToken& token) {
+        const auto& [scc_map, scc_count] = scc(token);
+        const int num_vertices = g.numVertices();
+        Condensation condensation{std::vector<std::vector<int>>(scc_count), std::vector<int>(scc_count, 0),
+                                  std::vector<int>(scc_count, -1), 0};
+        for (int u = 0; u < num_vertices; ++u) {
+            const int from = scc_map[u];
+            if (condensation.min_vertex[from] == -1) {
+                condensation.min_vertex[from] = u;
+            }
+            for (int v : g.outneighbors(u)) {
+                if (scc_map[v] != from) {
+                    condensation.successors[from].push_back(scc_map[v]);
+                }
+            }
+        }
+        for (auto& successors : condensation.successors) {
+            std::ranges::sort(successors);
+            const auto duplicates = std::ranges::unique(successors);
+            successors.erase(duplicates.begin(), duplicates.end());
+            for (int to : successors) {
+                condensation.in_degree[to]++;
+            }
+        }
+        condensation.num_sources = static_cast<int>(std::ranges::count(condensation.in_degree, 0));
+        return condensation;
+    }
+
+    // Kahn's algorithm on the condensation
+    std::vector<int> compute_topological_order(const CancellationToken& token) {
+        const Condensation& dag = condensation(token);
+        const int num_components = static_cast<int>(dag.successors.size());
+        std::vector<int> in_degree = dag.in_degree;
+        std::vector<int> order;
+        order.reserve(num_components);
+        std::queue<int> ready;
+        for (int c = 0; c < num_components; ++c) {
+            if (in_degree[c] == 0) ready.push(c);
+        }
+        while (!ready.empty()) {
+            const int c = ready.front();
+            ready.pop();
+            order.push_back(c);
+            for (int to : dag.successors[c]) {
+                if (--in_degree[to] == 0) ready.push(to);
+            }
+        }
+        return order;
+    }
+
+    // back edges of a DFS that stays inside the component, which is one of its feedback arc sets
+    FeedbackArcSet component_back_edges(const std::vector<int>& component, const std::vector<int>& scc_map,
+                                        std::vector<char>& state) const {
+        constexpr char white = 0, gray = 1, black = 2;
+        FeedbackArcSet back_edges;
+        const int component_id = scc_map[component.front()];
+        auto initial_neighbors = g.outneighbors(component.front());
+        using neighbor_iterator = decltype(initial_neighbors.begin());
+        std::vector<std::pair<int, neighbor_iterator>> stack;
+
+        // strongly connected, so the first vertex reaches the whole component
+        stack.emplace_back(component.front(), initial_neighbors.begin());
+        state[component.front()] = gray;
+        while (!stack.empty()) {
+            auto& [u, iter] = stack.back();
+            const auto end_iter = g.outneighbors(u).end();
+            bool found_white = false;
+            while (iter != end_iter) {
+                const int v = *iter;
+                ++iter;
+                if (scc_map[v] != component_id) continue;
+                if (state[v] == gray) {
+                    back_edges.emplace_back(u, v);
+                } else if (state[v] == white) {
+                    state[v] = gray;
+                    stack.emplace_back(v, g.outneighbors(v).begin());
+                    found_white = true;
+                    break;
+                }
+            }
+            if (!found_white) {
+                state[u] = black;
+                stack.pop_back();
+            }
+        }
+        return back_edges;
+    }
+
+public:
+    explicit AnalysisPipeline(const GraphTypeImplementationGeneralizer& graph) : g(graph) {}
+
+    AnalysisPipeline(const AnalysisPipeline&) = delete;
+    AnalysisPipeline& operator=(const AnalysisPipeline&) = delete;
+
+    const SccDecomposition& scc(const CancellationToken& token = {}) {
+        return get(scc_artifact, [&] { return Processor::strongly_connected_components(g, token); });
+    }
+
+    const Condensation& condensation(const CancellationToken& token = {}) {
+        return get(condensation_artifact, [&] { return compute_condensation(token); });
+    }
+
+    // components of scc() in topological order of the condensation
+    const std::vector<int>& topological_order(const CancellationToken& token = {}) {
+        return get(topological_order_artifact, [&] { return compute_topological_order(token); });
+    }
+
+    // number of artifacts computed so far, every artifact counts once
+    int computed_artifact_count() const {
+        return computed_artifacts.load(std::memory_order_relaxed);
+    }
+
+    AlgoResultVariant source_vertices(const CancellationToken& token = {}) {
+        token.throw_if_stop_requested();
+        return zero_degree_vertices<int>(g.in_degrees());
+    }
+
+    AlgoResultVariant diameter(const CancellationToken& token = {}) {
+        if (g.numVertices() <= 1) return 0;
+        if (scc(token).scc_count > 1) return -1; // some vertex cannot reach some other
+        return typename Processor::ParallelDiameterStrategy().execute(g, token);
+    }
+
+    AlgoResultVariant feedback_arc_set(const CancellationToken& token = {}) {
+        const SccDecomposition* decomposition;
+        try {
+            decomposition = &scc(token);
+        } catch (const OperationCancelled&) {
+            // the DFS strategy stops right away with a valid (partial) result
+            return typename Processor::FeedbackArcSetDfsStrategy().execute(g, token);
+        }
+        const auto& [scc_map, scc_count] = *decomposition;
+        const int num_vertices = g.numVertices();
+        std::vector<std::vector<int>> components(scc_count);
+        for (int u = 0; u < num_vertices; ++u) {
+            components[scc_map[u]].push_back(u);
+        }
+
+        // only edges inside a component can be on a cycle, the components are searched independently
+        std::vector<char> state(num_vertices, 0);
+        std::vector<FeedbackArcSet> component_results(scc_count);
+        std::atomic<bool> is_partial(false);
+        parallel_for(0, scc_count, [&](int c) {
+            const auto& component = components[c];
+            if (token.stop_requested()) {
+                // without the search keep the edges going to a higher index, that order has no cycles
+                is_partial.store(true, std::memory_order_relaxed);
+                for (int u : component) {
+                    for (int v : g.outneighbors(u)) {
+                        if (v <= u && scc_map[v] == c) component_results[c].emplace_back(u, v);
+                    }
+                }
+                return;
+            }
+            if (component.size() == 1) {
+                // only self loops, every copy of them
+                const int u = component.front();
+                for (int v : g.outneighbors(u)) {
+                    if (v == u) component_results[c].emplace_back(u, u);
+                }
+                return;
+            }
+            component_results[c] = component_back_edges(component, scc_map, state);
+        });
+
+        // in the order of the smallest vertex of the components
+        FeedbackArcSet result;
+        for (int u = 0; u < num_vertices; ++u) {
+            const int c = scc_map[u];
+            if (components[c].front() == u) {
+                result.insert(result.end(), component_results[c].begin(), component_results[c].end());
+            }
+        }
+        if (is_partial.load()) return PartialResult<FeedbackArcSet>{std::move(result)};
+        return result;
+    }
+
+    AlgoResultVariant universal_source(const CancellationToken& token = {}) {
+        const int num_vertices = g.numVertices();
+        if (num_vertices == 0) return -1;
+        if (num_vertices == 1) return 0;
+        // with a single source component every component is reachable from it, otherwise nothing reaches everything
+        const Condensation& dag = condensation(token);
+        if (dag.num_sources != 1) return -1;
+        return dag.min_vertex[topological_order(token).front()];
+    }
+
+    /**
+     * @brief Solves the four problems concurrently, the results are in problem order.
+     */
+    std::array<StageResult, 4> run(const CancellationToken& token = {}) {
+        std::array<StageResult, 4> results{
+            StageResult{"1", {}, 0.0}, StageResult{"2", {}, 0.0}, StageResult{"3", {}, 0.0}, StageResult{"4", {}, 0.0}};
+        std::array<std::exception_ptr, 4> errors{};
+        const std::array<AlgoResultVariant (AnalysisPipeline::*)(const CancellationToken&), 4> stages{
+            &AnalysisPipeline::source_vertices, &AnalysisPipeline::diameter,
+            &AnalysisPipeline::feedback_arc_set, &AnalysisPipeline::universal_source};
+
+        TaskGroup group;
+        for (size_t i = 0; i < stages.size(); ++i) {
+            group.run([&, i] {
+                try {
+                    const auto start = std::chrono::steady_clock::now();
+                    try {
+                        results[i].result = (this->*stages[i])(token);
+                    } catch (const OperationCancelled&) {
+                        results[i].result = std::string("cancelled");
+                    }
+                    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                    results[i].elapsed_sec = elapsed.count();
+                } catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        group.wait();
+        for (const auto& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+        return results;
+    }
+};
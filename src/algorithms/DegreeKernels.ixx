@@ -0,0 +1,153 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+export module DegreeKernels;
+
+import TaskScheduler;
+
+/**
+ * Kernels over whole degree arrays (IGraph::out_degrees() / in_degrees()).
+ *
+ * Every kernel splits the array into chunks of at least min_kernel_chunk entries for the task scheduler, smaller
+ * arrays run on the calling thread. The inner loops work on fixed size blocks without branches or early exits,
+ * so the compiler vectorizes them; problem 1 is a single pass over the in-degree array.
+ */
+
+constexpr size_t simd_block = 16;
+constexpr size_t min_kernel_chunk = size_t{1} << 14;
+
+size_t kernel_chunk_size(size_t count, TaskScheduler& scheduler) {
+    return std::max(min_kernel_chunk, scheduler.chunk_size_for(count));
+}
+
+size_t chunk_count(size_t count, size_t chunk) {
+    return (count + chunk - 1) / chunk;
+}
+
+// or-reduction instead of an early exit, so the loop vectorizes
+template <typename Degree>
+bool block_has_zero(const Degree* block) {
+    unsigned zeros = 0;
+    for (size_t j = 0; j < simd_block; ++j) {
+        zeros |= static_cast<unsigned>(block[j] == 0);
+    }
+    return zeros != 0;
+}
+
+/**
+ * @brief Vertices with degree 0 in increasing order: the sources for in_degrees(), the sinks for out_degrees().
+ * Blocks without a zero are skipped after one vectorized test, only the rest is scanned per element.
+ */
+export template <typename VertexId, typename Degree>
+std::vector<VertexId> zero_degree_vertices(std::span<const Degree> degrees,
+                                           TaskScheduler& scheduler = TaskScheduler::global()) {
+    const size_t count = degrees.size();
+    const size_t chunk = kernel_chunk_size(count, scheduler);
+    std::vector<std::vector<VertexId>> partials(chunk_count(count, chunk));
+    parallel_for_chunks(size_t{0}, count, [&](size_t chunk_begin, size_t chunk_end) {
+        auto& found = partials[chunk_begin / chunk];
+        size_t i = chunk_begin;
+        for (; i + simd_block <= chunk_end; i += simd_block) {
+            if (!block_has_zero(degrees.data() + i)) continue;
+            for (size_t j = i; j < i + simd_block; ++j) {
+                if (degrees[j] == 0) found.push_back(static_cast<VertexId>(j));
+            }
+        }
+        for (; i < chunk_end; ++i) {
+            if (degrees[i] == 0) found.push_back(static_cast<VertexId>(i));
+        }
+    }, chunk, scheduler);
+
+    if (partials.size() == 1) return std::move(partials.front());
+    size_t total = 0;
+    for (const auto& found : partials) total += found.size();
+    std::vector<VertexId> result;
+    result.reserve(total);
+    for (const auto& found : partials) {
+        result.insert(result.end(), found.begin(), found.end());
+    }
+    return result;
+}
+
+export template <typename Degree>
+size_t count_zero_degrees(std::span<const Degree> degrees, TaskScheduler& scheduler = TaskScheduler::global()) {
+    const size_t count = degrees.size();
+    const size_t chunk = kernel_chunk_size(count, scheduler);
+    std::vector<size_t> partials(chunk_count(count, chunk), 0);
+    parallel_for_chunks(size_t{0}, count, [&](size_t chunk_begin, size_t chunk_end) {
+        size_t zeros = 0;
+        for (size_t i = chunk_begin; i < chunk_end; ++i) {
+            zeros += degrees[i] == 0;
+        }
+        partials[chunk_begin / chunk] = zeros;
+    }, chunk, scheduler);
+    size_t total = 0;
+    for (size_t zeros : partials) total += zeros;
+    return total;
+}
+
+/**
+ * @brief out_degrees[u] - in_degrees[u] for every vertex.
+ */
+export template <typename Degree>
+std::vector<long> degree_difference(std::span<const Degree> out_degrees, std::span<const Degree> in_degrees,
+                                    TaskScheduler& scheduler = TaskScheduler::global()) {
+    const size_t count = std::min(out_degrees.size(), in_degrees.size());
+    std::vector<long> difference(count);
+    parallel_for_chunks(size_t{0}, count, [&](size_t chunk_begin, size_t chunk_end) {
+        for (size_t i = chunk_begin; i < chunk_end; ++i) {
+            difference[i] = static_cast<long>(out_degrees[i]) - static_cast<long>(in_degrees[i]);
+        }
+    }, kernel_chunk_size(count, scheduler), scheduler);
+    return difference;
+}
+
+export template <typename Degree>
+Degree max_degree(std::span<const Degree> degrees, TaskScheduler& scheduler = TaskScheduler::global()) {
+    const size_t count = degrees.size();
+    const size_t chunk = kernel_chunk_size(count, scheduler);
+    std::vector<Degree> partials(chunk_count(count, chunk), Degree{0});
+    parallel_for_chunks(size_t{0}, count, [&](size_t chunk_begin, size_t chunk_end) {
+        Degree local = 0;
+        for (size_t i = chunk_begin; i < chunk_end; ++i) {
+            local = std::max(local, degrees[i]);
+        }
+        partials[chunk_begin / chunk] = local;
+    }, chunk, scheduler);
+    Degree result = 0;
+    for (Degree local : partials) result = std::max(result, local);
+    return result;
+}
+
+/**
+ * @brief histogram[d] is the number of vertices with degree d, up to the largest degree (empty without vertices).
+ * Every chunk counts into its own histogram, they are summed at the end.
+ */
+export template <typename Degree>
+std::vector<size_t> degree_histogram(std::span<const Degree> degrees,
+                                     TaskScheduler& scheduler = TaskScheduler::global()) {
+    const size_t count = degrees.size();
+    if (count == 0) return {};
+    const size_t buckets = static_cast<size_t>(max_degree(degrees, scheduler)) + 1;
+    const size_t chunk = kernel_chunk_size(count, scheduler);
+    std::vector<std::vector<size_t>> partials(chunk_count(count, chunk));
+    parallel_for_chunks(size_t{0}, count, [&](size_t chunk_begin, size_t chunk_end) {
+        std::vector<size_t> local(buckets, 0);
+        for (size_t i = chunk_begin; i < chunk_end; ++i) {
+            ++local[static_cast<size_t>(degrees[i])];
+        }
+        partials[chunk_begin / chunk] = std::move(local);
+    }, chunk, scheduler);
+
+    std::vector<size_t> histogram = std::move(partials.front());
+    for (size_t c = 1; c < partials.size(); ++c) {
+        for (size_t d = 0; d < buckets; ++d) {
+            histogram[d] += partials[c][d];
+        }
+    }
+    return histogram;
+}
@@ -2,17 +2,14 @@ module;
 
 #include <algorithm>
 #include <atomic>
-#include <execution>
-#include <future>
 #include <iostream>
+#include <memory_resource>
 #include <numeric>
 #include <optional>
-#include <queue>
 #include <ranges>
 #include <utility>
 #include <vector>
 #include <stack>
-#include <thread>
 
 export module GraphAlgo;
 
@@ -20,12 +17,21 @@ import GraphConcepts;
 import IAlgorithm;
 import AlgorithmResult;
 import Properties;
-
-class ImplementedGraph;
+import ImplementedGraph;
+import TaskScheduler;
+import Cancellation;
+import DegreeKernels;
+import MemoryResources;
+
+export struct SccDecomposition {
+    std::vector<int> scc_map; // vertex -> component id
+    int scc_count = 0;
+};
 
 struct BfsResult {
     int eccentricity;
     bool is_connected;
+    bool is_complete = true; // false if the BFS was skipped because of a cancellation
 };
 
 export template <IsGraph GraphTypeImplementationGeneralizer = ImplementedGraph, typename AlgorithmInterface = IAlgorithm<GraphTypeImplementationGeneralizer>, bool isDebugMode = false>
@@ -35,8 +41,17 @@ class GraphProcessor
 public:
     using implementation_generalizer_type = GraphTypeImplementationGeneralizer;
     using algorithm_interface_type = AlgorithmInterface;
+    // storage types of the graph; the strategies themselves index vertices with int, as the results in AlgoResultVariant do
+    using vertex_type = typename GraphTypeImplementationGeneralizer::vertex_type;
+    using edge_offset_type = typename GraphTypeImplementationGeneralizer::edge_offset_type;
+
+    // the DFS loops poll the token every dfs_poll_interval vertices they discover, a single root can span the whole graph
+    static constexpr int dfs_poll_interval = 1024;
 
-    static void DFS_util_recursive(const GraphTypeImplementationGeneralizer& g, int u, std::vector<bool>& visited, std::vector<int>& finish_order) {
+    // Scratch memory: every execute() allocates from its own ExecutionArena (one per task in the parallel strategies)
+    // and sizes its buffers once, the helpers below take those buffers or allocate from the arena of the ones given.
+
+    static void DFS_util_recursive(const GraphTypeImplementationGeneralizer& g, int u, ScratchVector<bool>& visited, ScratchVector<int>& finish_order) {
         visited[u] = true;
         for (int v : g.outneighbors(u)) {
             if (!visited[v]) {
@@ -47,14 +62,16 @@ public:
     }
 
     // Iterative version of DFS_util
-    static void DFS_util(const GraphTypeImplementationGeneralizer& g, int u_start, std::vector<bool>& visited, std::vector<int>& finish_order) {
+    static void DFS_util(const GraphTypeImplementationGeneralizer& g, int u_start, ScratchVector<bool>& visited, ScratchVector<int>& finish_order,
+                         const CancellationToken& token = {}) {
         auto initial_neighbors = g.outneighbors(u_start);
         using neighbor_iterator = decltype(initial_neighbors.begin());
 
-        std::vector<std::pair<int, neighbor_iterator>> stack;
+        ScratchVector<std::pair<int, neighbor_iterator>> stack(visited.get_allocator());
 
         stack.emplace_back(u_start, initial_neighbors.begin());
         visited[u_start] = true;
+        int discovered = 1;
 
         while (!stack.empty()) {
             auto& [u, iter] = stack.back();
@@ -65,6 +82,7 @@ public:
                 int v = *iter;
                 ++iter;
                 if (!visited[v]) {
+                    if (++discovered % dfs_poll_interval == 0) token.throw_if_stop_requested();
                     visited[v] = true;
                     auto v_neighbors = g.outneighbors(v);
                     stack.emplace_back(v, v_neighbors.begin());
@@ -80,7 +98,7 @@ public:
         }
     }
 
-    static void DFS_collect_scc_recursive(const GraphTypeImplementationGeneralizer& g, int u, std::vector<bool>& visited, std::vector<int>& component) {
+    static void DFS_collect_scc_recursive(const GraphTypeImplementationGeneralizer& g, int u, ScratchVector<bool>& visited, ScratchVector<int>& component) {
         //should use transposed
         visited[u] = true;
         component.push_back(u);
@@ -92,22 +110,23 @@ public:
     }
 
     // Iterative version of DFS_collect_scc
-    static void DFS_collect_scc(const GraphTypeImplementationGeneralizer& g, int u_start, std::vector<bool>& visited, std::vector<int>& component) {
-        std::vector<int> stack;
+    static void DFS_collect_scc(const GraphTypeImplementationGeneralizer& g, int u_start, ScratchVector<bool>& visited, ScratchVector<int>& component,
+                                const CancellationToken& token = {}) {
+        ScratchVector<int> stack(visited.get_allocator());
         stack.push_back(u_start);
         visited[u_start] = true;
+        int discovered = 1;
 
         while (!stack.empty()) {
             int u = stack.back();
             stack.pop_back();
             component.push_back(u);
 
-            auto neighbors_range = g.outneighbors(u);
-            std::vector<int> neighbors(std::begin(neighbors_range), std::end(neighbors_range));
-
+            const auto neighbors = g.outneighbors(u);
             for (auto it = neighbors.rbegin(); it != neighbors.rend(); ++it) {
                 int v = *it;
                 if (!visited[v]) {
+                    if (++discovered % dfs_poll_interval == 0) token.throw_if_stop_requested();
                     visited[v] = true;
                     stack.push_back(v);
                 }
@@ -117,28 +136,196 @@ public:
 
     /**
      * @brief Checks if a path exists from a start node to an end node using BFS.
+     * visited (all false, numVertices() entries) and queue (empty) are reused by repeated calls, both are left
+     * the way they were given.
      */
-    static bool has_path(const GraphTypeImplementationGeneralizer& g, int start_node, int end_node) {
+    static bool has_path(const GraphTypeImplementationGeneralizer& g, int start_node, int end_node,
+                         ScratchVector<char>& visited, ScratchVector<int>& queue) {
         if (start_node == end_node) return true;
-        std::vector<bool> visited(g.numVertices(), false);
-        std::queue<int> q;
-
-        q.push(start_node);
+        queue.push_back(start_node);
         visited[start_node] = true;
 
-        while (!q.empty()) {
-            int u = q.front();
-            q.pop();
-
-            for (int v : g.outneighbors(u)) {
-                if (v == end_node) return true;
+        bool found = false;
+        for (size_t head = 0; head < queue.size() && !found; ++head) {
+            for (int v : g.outneighbors(queue[head])) {
+                if (v == end_node) {
+                    found = true;
+                    break;
+                }
                 if (!visited[v]) {
                     visited[v] = true;
-                    q.push(v);
+                    queue.push_back(v);
+                }
+            }
+        }
+        // only the queued vertices were marked
+        for (int u : queue) visited[u] = false;
+        queue.clear();
+        return found;
+    }
+
+    static bool has_path(const GraphTypeImplementationGeneralizer& g, int start_node, int end_node) {
+        ExecutionArena arena;
+        ScratchVector<char> visited(g.numVertices(), false, &arena);
+        ScratchVector<int> queue(&arena);
+        return has_path(g, start_node, end_node, visited, queue);
+    }
+
+    /**
+     * @brief BFS from source: its eccentricity and whether it reaches every vertex. dist (all -1, numVertices()
+     * entries) and queue (empty) are reused by repeated calls, both are left the way they were given.
+     */
+    static BfsResult bfs_from(const GraphTypeImplementationGeneralizer& g, int source, ScratchVector<int>& dist, ScratchVector<int>& queue) {
+        dist[source] = 0;
+        queue.push_back(source);
+        int current_max = 0;
+        for (size_t head = 0; head < queue.size(); ++head) {
+            const int u = queue[head];
+            for (int v : g.outneighbors(u)) {
+                if (dist[v] == -1) {
+                    dist[v] = dist[u] + 1;
+                    queue.push_back(v);
+                    current_max = std::max(current_max, dist[v]);
+                }
+            }
+        }
+        const bool reaches_all = queue.size() == static_cast<size_t>(g.numVertices());
+        for (int u : queue) dist[u] = -1;
+        queue.clear();
+        return BfsResult{current_max, reaches_all};
+    }
+
+    /**
+     * @brief Position of every vertex in a topological order (Kahn's algorithm), the graph has to be acyclic.
+     */
+    static std::vector<int> topological_positions(const GraphTypeImplementationGeneralizer& g) {
+        const int num_vertices = g.numVertices();
+        const auto in_degrees = g.in_degrees();
+        ExecutionArena arena;
+        ScratchVector<int> in_degree(in_degrees.begin(), in_degrees.end(), &arena);
+        std::vector<int> ready = zero_degree_vertices<int>(in_degrees);
+        std::vector<int> position(num_vertices, -1);
+        int next_position = 0;
+        while (!ready.empty()) {
+            const int u = ready.back();
+            ready.pop_back();
+            position[u] = next_position++;
+            for (int v : g.outneighbors(u)) {
+                if (--in_degree[v] == 0) ready.push_back(v);
+            }
+        }
+        return position;
+    }
+
+    /**
+     * @brief Tarjan's strongly connected components, iterative. Components are numbered in reverse topological order
+     * of the condensation: an edge between two components always goes to the one with the smaller id.
+     */
+    static SccDecomposition strongly_connected_components(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) {
+        const int num_vertices = g.numVertices();
+        ExecutionArena arena;
+        ScratchVector<int> ids(num_vertices, -1, &arena);
+        ScratchVector<int> low(num_vertices, -1, &arena);
+        ScratchVector<bool> onStack(num_vertices, false, &arena);
+        ScratchVector<int> st(&arena);
+        st.reserve(num_vertices);
+        using neighbor_iterator = decltype(g.outneighbors(0).begin());
+        // empty again after every root
+        ScratchVector<std::tuple<int, neighbor_iterator, neighbor_iterator>> dfs_stack(&arena);
+
+        std::vector<int> scc_map(num_vertices, -1);
+        int scc_count = 0;
+        int id_counter = 0;
+
+        /*
+        std::function<void(int)> tarjan_dfs =
+            [&](int at) {
+            st.push_back(at);
+            onStack[at] = true;
+            ids[at] = low[at] = id_counter++;
+
+            for (int to : g.outneighbors(at)) {
+                if (ids[to] == -1) {
+                    tarjan_dfs(to);
+                    low[at] = std::min(low[at], low[to]);
+                } else if (onStack[to]) {
+                    low[at] = std::min(low[at], ids[to]);
+                }
+            }
+
+            if (ids[at] == low[at]) {
+                while (true) {
+                    int node = st.back();
+                    st.pop_back();
+                    onStack[node] = false;
+                    scc_map[node] = scc_count;
+                    if (node == at) break;
+                }
+                scc_count++;
+            }
+        };
+
+        for (int i = 0; i < num_vertices; ++i) {
+            if (ids[i] == -1) {
+                tarjan_dfs(i);
+            }
+        }
+         */
+
+        for (int i = 0; i < num_vertices; ++i) {
+            if (ids[i] == -1) {
+                token.throw_if_stop_requested();
+                auto initial_neighbors = g.outneighbors(i);
+                dfs_stack.emplace_back(i, initial_neighbors.begin(), initial_neighbors.end());
+                st.push_back(i);
+                onStack[i] = true;
+                ids[i] = low[i] = id_counter++;
+
+                while(!dfs_stack.empty()) {
+                    auto& [at, it, end_it] = dfs_stack.back();
+
+                    bool pushed_new = false;
+                    while(it != end_it) {
+                        int to = *it;
+                        ++it;
+
+                        if (ids[to] == -1) {
+                            if (id_counter % dfs_poll_interval == 0) token.throw_if_stop_requested();
+                            st.push_back(to);
+                            onStack[to] = true;
+                            ids[to] = low[to] = id_counter++;
+                            auto to_neighbors = g.outneighbors(to);
+                            dfs_stack.emplace_back(to, to_neighbors.begin(), to_neighbors.end());
+                            pushed_new = true;
+                            break;
+                        } else if (onStack[to]) {
+                            low[at] = std::min(low[at], ids[to]);
+                        }
+                    }
+
+                    if (!pushed_new) {
+                        if (ids[at] == low[at]) {
+                            while (true) {
+                                int node = st.back();
+                                st.pop_back();
+                                onStack[node] = false;
+                                scc_map[node] = scc_count;
+                                if (node == at) break;
+                            }
+                            scc_count++;
+                        }
+
+                        dfs_stack.pop_back();
+                        if(!dfs_stack.empty()) {
+                            auto& [parent, parent_it, parent_end_it] = dfs_stack.back();
+                            low[parent] = std::min(low[parent], low[at]);
+                        }
+                    }
                 }
             }
         }
-        return false;
+
+        return SccDecomposition{std::move(scc_map), scc_count};
     }
 
     class SourceVertexStrategy : public AlgorithmInterface {
@@ -148,30 +335,10 @@ public:
         using preferred_graph_properties = GraphProperties::CacheLocal;
         using algorithm_interface = AlgorithmInterface;
         const char* getName() const override { return "1"; }
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
-            std::vector<int> sources;
-            const int num_vertices = g.numVertices();
-            sources.reserve(num_vertices / 10);
-            for (int i = 0; i < num_vertices; ++i) {
-                if (g.in_degree(i) == 0) {
-                    sources.push_back(i);
-                }
-            }
-            //could do something parallel, but probably slower:
-            /*
-            auto const vertices = std::views::iota(0, num_vertices);
-            std::mutex mtx;
-
-            std::for_each(std::execution::par, vertices.begin(), vertices.end(),
-                [&](int i) {
-                    if (g.inneighbors(i).empty()) {
-                        std::lock_guard<std::mutex> lock(mtx);
-                        sources.push_back(i);
-                    }
-                });
-             *
-             */
-            return sources;
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
+            // one vectorized pass over the in-degree array, too short to poll the token inside
+            token.throw_if_stop_requested();
+            return zero_degree_vertices<int>(g.in_degrees());
         }
     };
 
@@ -179,40 +346,28 @@ public:
         public:
         using solves_problem = Problem::DiameterMeasure;
         using properties = AlgorithmProperties::SparseGraphPreferred;
-        using preferred_graph_properties = GraphProperties::CacheLocal;
+        using preferred_graph_properties = GraphProperties::DegreeAdaptive;
         using algorithm_interface = AlgorithmInterface;
         const char* getName() const override { return "2-seq"; }
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
             if (num_vertices <= 1) return 0;
             int max_diameter = 0;
+            ExecutionArena arena;
+            ScratchVector<int> dist(num_vertices, -1, &arena);
+            ScratchVector<int> queue(&arena);
+            queue.reserve(num_vertices);
 
             for (int i = 0; i < num_vertices; ++i) { //BFS from every vertex
-                std::vector<int> dist(num_vertices, -1);
-                std::queue<int> q;
-                dist[i] = 0;
-                q.push(i);
-                int visited_count = 1;
-                int current_max = 0;
-                while (!q.empty()) {
-                    int u = q.front();
-                    q.pop();
-
-                    for (int v : g.outneighbors(u)) { //BFS loop
-                        if (dist[v] == -1) {
-                            dist[v] = dist[u] + 1;
-                            q.push(v);
-                            visited_count++;
-                            current_max = std::max(current_max, dist[v]);
-                        }
-                    }
-                }
+                // the eccentricities so far are a lower bound of the diameter
+                if (token.stop_requested()) return PartialResult<int>{max_diameter};
+                const BfsResult result = bfs_from(g, i, dist, queue);
 
                 // Early termination
-                if (visited_count != num_vertices) {
+                if (!result.is_connected) {
                     return -1;
                 }
-                max_diameter = std::max(max_diameter, current_max);
+                max_diameter = std::max(max_diameter, result.eccentricity);
             }
             return max_diameter;
         }
@@ -222,62 +377,49 @@ public:
     public:
         using solves_problem = Problem::DiameterMeasure;
         using properties = AlgorithmProperties::SparseGraphPreferred;
-        using preferred_graph_properties = GraphProperties::CacheLocal;
+        using preferred_graph_properties = GraphProperties::DegreeAdaptive;
         using algorithm_interface = AlgorithmInterface;
         const char* getName() const override {
             if (isDebugMode) return "2-async";
             else return "2";
         }
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
             if (num_vertices <= 1) return 0;
 
-            const unsigned int num_cores = std::thread::hardware_concurrency();
-            const int num_workers = (num_cores > 0) ? num_cores*2 : 4;
-            const int workers_to_launch = std::min(num_vertices, num_workers);
+            TaskScheduler& scheduler = TaskScheduler::global();
+            const int workers_to_launch = std::min(num_vertices, static_cast<int>(scheduler.num_workers()));
 
-            std::vector<std::future<std::vector<BfsResult>>> futures;
-            futures.reserve(workers_to_launch);
+            // one result list per worker task, written only by that task
+            std::vector<std::vector<BfsResult>> worker_results(workers_to_launch);
 
             std::atomic<int> next_vertex_idx(0);
 
             // LAUNCH WORKERS
+            TaskGroup group(scheduler);
             for (int i = 0; i < workers_to_launch; ++i) {
-                futures.push_back(std::async(std::launch::async, [&]() {
-                    std::vector<BfsResult> local_results;
+                group.run([&, i]() {
+                    std::vector<BfsResult>& local_results = worker_results[i];
+                    // the buffers of one worker serve all of its BFS runs
+                    ExecutionArena arena;
+                    ScratchVector<int> dist(num_vertices, -1, &arena);
+                    ScratchVector<int> queue(&arena);
+                    queue.reserve(num_vertices);
                     int vertex_idx;
                     // Worker loop
-                    while ((vertex_idx = next_vertex_idx.fetch_add(1)) < num_vertices) {
-                        std::vector<int> dist(num_vertices, -1);
-                        std::queue<int> q;
-                        dist[vertex_idx] = 0;
-                        q.push(vertex_idx);
-                        int visited_count = 1;
-                        int current_max = 0;
-                        while (!q.empty()) {
-                            int u = q.front();
-                            q.pop();
-                            for (int v : g.outneighbors(u)) {
-                                if (dist[v] == -1) {
-                                    dist[v] = dist[u] + 1;
-                                    q.push(v);
-                                    visited_count++;
-                                    current_max = std::max(current_max, dist[v]);
-                                }
-                            }
-                        }
-                        bool connected_from_this_node = (visited_count == num_vertices);
-                        local_results.push_back(BfsResult{current_max, connected_from_this_node});
+                    while (!token.stop_requested() && (vertex_idx = next_vertex_idx.fetch_add(1)) < num_vertices) {
+                        local_results.push_back(bfs_from(g, vertex_idx, dist, queue));
                     }
-                    return local_results;
-                }));
+                });
             }
+            group.wait();
 
             //AGGREGATION
             int max_diameter = 0;
             bool is_graph_strongly_connected = true;
-            for (auto& fut : futures) {
-                std::vector<BfsResult> local_results = fut.get();
+            size_t num_results = 0;
+            for (const auto& local_results : worker_results) {
+                num_results += local_results.size();
                 for (const auto& result : local_results) {
                     if (!result.is_connected) {
                         is_graph_strongly_connected = false;
@@ -289,6 +431,7 @@ public:
             }
 
             if (!is_graph_strongly_connected) return -1;
+            if (num_results != static_cast<size_t>(num_vertices)) return PartialResult<int>{max_diameter}; // cancelled
             return max_diameter;
         }
     };
@@ -297,53 +440,50 @@ public:
     public:
         using solves_problem = Problem::DiameterMeasure;
         using properties = AlgorithmProperties::SparseGraphPreferred;
-        using preferred_graph_properties = GraphProperties::CacheLocal;
+        using preferred_graph_properties = GraphProperties::DegreeAdaptive;
         using algorithm_interface = AlgorithmInterface;
         const char* getName() const override {
             if (isDebugMode) return "2-par";
             else return "2";
         }
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
             if (num_vertices <= 1) return 0;
-            auto indices = std::views::iota(0, num_vertices);
-            BfsResult initial_value = {0, true};
-            BfsResult final_result = std::transform_reduce(
-                std::execution::par, //maybe par_unseq also works?
-                indices.begin(), indices.end(),
-                initial_value,
-                //Reducer
-                [](BfsResult a, BfsResult b) {
-                    return BfsResult {
-                        std::max(a.eccentricity, b.eccentricity),
-                        // branchless ?? a.is_connected && b.is_connected
-                        static_cast<bool>(a.is_connected & b.is_connected)
-                    };
-                },
-                //Transform
-                [&g, num_vertices](int i) {
-                    std::vector<int> dist(num_vertices, -1);
-                    std::queue<int> q;
-                    dist[i] = 0;
-                    q.push(i);
-                    int visited_count = 1;
-                    int current_max = 0;
-                    while (!q.empty()) {
-                        int u = q.front();
-                        q.pop();
-                        for (int v : g.outneighbors(u)) {
-                            if (dist[v] == -1) {
-                                dist[v] = dist[u] + 1;
-                                q.push(v);
-                                visited_count++;
-                                current_max = std::max(current_max, dist[v]);
-                            }
-                        }
+            BfsResult initial_value = {0, true, true};
+            //Reducer
+            auto reduce = [](BfsResult a, BfsResult b) {
+                return BfsResult {
+                    std::max(a.eccentricity, b.eccentricity),
+                    // branchless ?? a.is_connected && b.is_connected
+                    static_cast<bool>(a.is_connected & b.is_connected),
+                    static_cast<bool>(a.is_complete & b.is_complete)
+                };
+            };
+            // chunks instead of parallel_transform_reduce, so the BFS buffers are allocated once per chunk
+            TaskScheduler& scheduler = TaskScheduler::global();
+            const size_t chunk = scheduler.chunk_size_for(static_cast<size_t>(num_vertices));
+            std::vector<BfsResult> partials((static_cast<size_t>(num_vertices) + chunk - 1) / chunk, initial_value);
+            parallel_for_chunks(0, num_vertices, [&](int chunk_begin, int chunk_end) {
+                ExecutionArena arena;
+                ScratchVector<int> dist(num_vertices, -1, &arena);
+                ScratchVector<int> queue(&arena);
+                queue.reserve(num_vertices);
+                BfsResult local = initial_value;
+                for (int i = chunk_begin; i < chunk_end; ++i) {
+                    if (token.stop_requested()) {
+                        local.is_complete = false;
+                        break;
                     }
-                    return BfsResult{current_max, (visited_count == num_vertices)};
+                    local = reduce(local, bfs_from(g, i, dist, queue));
                 }
-            );
+                partials[static_cast<size_t>(chunk_begin) / chunk] = local;
+            }, chunk, scheduler);
+            BfsResult final_result = initial_value;
+            for (const BfsResult& partial : partials) {
+                final_result = reduce(final_result, partial);
+            }
 
+            if (final_result.is_connected && !final_result.is_complete) return PartialResult<int>{final_result.eccentricity};
             // branchless: final_result.is_connected ? final_result.eccentricity : -1; false == 0
             return (final_result.eccentricity * final_result.is_connected) + (-1 * !final_result.is_connected);
         }
@@ -360,7 +500,7 @@ public:
             else return "3a";
         }
 
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
             if (num_vertices == 0) {
                 return std::vector<std::pair<int, int>>{};
@@ -368,10 +508,21 @@ public:
 
             GraphTypeImplementationGeneralizer graph_copy {g};
             std::vector<std::pair<int, int>> removed_edges;
+            // shared by every cycle search and path check
+            ExecutionArena arena;
+            ScratchVector<char> visited(num_vertices, false, &arena);
+            ScratchVector<char> on_current_path(num_vertices, false, &arena);
+            ScratchVector<int> stack(&arena);
 
             // find cycles
             while (true) {
-                std::optional<std::pair<int, int>> back_edge = find_cycle(graph_copy);
+                if (token.stop_requested()) {
+                    // the back edges of one DFS break the remaining cycles
+                    auto rest = std::get<std::vector<std::pair<int, int>>>(FeedbackArcSetDfsStrategy().execute(graph_copy));
+                    removed_edges.insert(removed_edges.end(), rest.begin(), rest.end());
+                    return PartialResult<std::vector<std::pair<int, int>>>{std::move(removed_edges)};
+                }
+                std::optional<std::pair<int, int>> back_edge = find_cycle(graph_copy, visited, on_current_path, stack);
                 if (back_edge) {
                     graph_copy.removeEdge(back_edge->first, back_edge->second);
                     removed_edges.push_back(*back_edge);
@@ -382,12 +533,19 @@ public:
 
             // re-insert
             std::vector<std::pair<int, int>> minimal_feedback_arc_set;
-            for (const auto& edge : removed_edges) {
+            std::ranges::fill(visited, false);
+            for (size_t i = 0; i < removed_edges.size(); ++i) {
+                if (token.stop_requested()) {
+                    // graph_copy is acyclic, the edges not tried yet just stay removed
+                    minimal_feedback_arc_set.insert(minimal_feedback_arc_set.end(), removed_edges.begin() + i, removed_edges.end());
+                    return PartialResult<std::vector<std::pair<int, int>>>{std::move(minimal_feedback_arc_set)};
+                }
+                const auto& edge = removed_edges[i];
                 int u = edge.first;
                 int v = edge.second;
 
                 // If v->u path exists, re-adding (u, v) would create a cycle.
-                if (has_path(graph_copy, v, u)) {
+                if (has_path(graph_copy, v, u, visited, stack)) {
                     minimal_feedback_arc_set.push_back(edge);
                 } else {
                     graph_copy.addEdge(u, v);
@@ -397,18 +555,23 @@ public:
             return minimal_feedback_arc_set;
         }
 
-        std::optional<std::pair<int, int>> find_cycle(const GraphTypeImplementationGeneralizer& g) const {
+        // visited and on_current_path have numVertices() entries, they and the stack are cleared here
+        std::optional<std::pair<int, int>> find_cycle(const GraphTypeImplementationGeneralizer& g, ScratchVector<char>& visited,
+                                                      ScratchVector<char>& on_current_path, ScratchVector<int>& stack) const {
             const int num_vertices = g.numVertices();
-            std::vector<bool> visited(num_vertices, false);
-            // std::vector<bool> on_current_path(num_vertices, false);
+            std::ranges::fill(visited, false);
+            // a cycle found last time leaves its path marked
+            std::ranges::fill(on_current_path, false);
 
             for (int i = 0; i < num_vertices; ++i) {
                 if (!visited[i]) {
-                    if (auto back_edge = find_cycle_dfs_util(g, i, visited/*, on_current_path*/); back_edge) {
+                    stack.clear();
+                    if (auto back_edge = find_cycle_dfs_util(g, i, visited, on_current_path, stack); back_edge) {
                         return back_edge;
                     }
                 }
             }
+            stack.clear();
             return std::nullopt;
         }
 
@@ -434,10 +597,8 @@ public:
         // }
 
         // Iterative
-        std::optional<std::pair<int, int>> find_cycle_dfs_util(const GraphTypeImplementationGeneralizer& g, int u_start, std::vector<bool>& visited) const {
-            auto initial_neighbors = g.outneighbors(u_start);
-            std::vector<int> stack;
-            std::vector<bool> on_current_path(g.numVertices(), false);
+        std::optional<std::pair<int, int>> find_cycle_dfs_util(const GraphTypeImplementationGeneralizer& g, int u_start, ScratchVector<char>& visited,
+                                                               ScratchVector<char>& on_current_path, ScratchVector<int>& stack) const {
             stack.emplace_back(u_start);
             visited[u_start] = true;
             on_current_path[u_start] = true;
@@ -485,7 +646,7 @@ public:
             else return "3b";
         }
 
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
             if (num_vertices == 0) {
                 return std::vector<std::pair<int, int>>{};
@@ -501,8 +662,9 @@ public:
 
             // This would also work: GraphTypeImplementationGeneralizer acyclic_graph {g};
 
-            std::vector<std::pair<int, int>> all_edges;
-            all_edges.reserve(g.numVertices()); //prealloc
+            ExecutionArena arena;
+            ScratchVector<std::pair<int, int>> all_edges(&arena);
+            all_edges.reserve(static_cast<size_t>(g.numEdges())); //prealloc
             for (int u = 0; u < num_vertices; ++u) {
                 for (int v : g.outneighbors(u)) {
                     all_edges.push_back({u, v});
@@ -510,10 +672,7 @@ public:
             }
 
             // Heuristic for ordering: process edges from vertices with a high (out-degree - in-degree) first.
-            std::vector<long> delta(num_vertices);
-            for (int i = 0; i < num_vertices; ++i) {
-                delta[i] = static_cast<long>(g.outneighbors(i).size()) - g.inneighbors(i).size();
-            }
+            const std::vector<long> delta = degree_difference(g.out_degrees(), g.in_degrees());
             // could be operator<=> on a class of edges
             auto compare_edges = [&](const auto& edge_a, const auto& edge_b) {
                 // Primary sort key: delta of source vertex, descending.
@@ -536,10 +695,23 @@ public:
             };
             std::ranges::sort(all_edges, compare_edges);
             std::vector<std::pair<int, int>> discarded_edges;
-            for (const auto& edge : all_edges) {
+            ScratchVector<char> visited(num_vertices, false, &arena);
+            ScratchVector<int> queue(&arena);
+            for (size_t i = 0; i < all_edges.size(); ++i) {
+                if (token.stop_requested()) {
+                    // keep the remaining edges that agree with a topological order of the acyclic part
+                    const std::vector<int> position = topological_positions(acyclic_graph);
+                    for (auto it = all_edges.begin() + i; it != all_edges.end(); ++it) {
+                        if (position[it->first] >= position[it->second]) {
+                            discarded_edges.push_back(*it);
+                        }
+                    }
+                    return PartialResult<std::vector<std::pair<int, int>>>{std::move(discarded_edges)};
+                }
+                const auto& edge = all_edges[i];
                 auto [u, v] = edge;
                 // Check if adding the edge (u, v) would create a cycle.
-                if (has_path(acyclic_graph, v, u)) {
+                if (has_path(acyclic_graph, v, u, visited, queue)) {
                     discarded_edges.push_back(edge);
                 } else {
                     acyclic_graph.addEdge(u, v);
@@ -563,14 +735,18 @@ public:
             else return "3c";
         }
 
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
             std::vector<std::pair<int, int>> back_edges;
-            std::vector<Color> colors(num_vertices, Color::WHITE);
+            ExecutionArena arena;
+            ScratchVector<Color> colors(num_vertices, Color::WHITE, &arena);
 
+            int discovered = 0;
             for (int i = 0; i < num_vertices; ++i) {
                 if (colors[i] == Color::WHITE) {
-                    coloured_dfs_util_recursive(g, i, colors, back_edges);
+                    if (token.stop_requested() || !coloured_dfs_util_recursive(g, i, colors, back_edges, token, discovered)) {
+                        return partial_back_edges(g, colors, std::move(back_edges));
+                    }
                 }
             }
             return back_edges;
@@ -578,7 +754,10 @@ public:
 
         enum class Color { WHITE, GRAY, BLACK };
 
-        void coloured_dfs_util_recursive(const GraphTypeImplementationGeneralizer& g, int u, std::vector<Color>& colors, std::vector<std::pair<int, int>>& back_edges) const {
+        // false if the token stopped the DFS, the vertices on the current path are left GRAY
+        bool coloured_dfs_util_recursive(const GraphTypeImplementationGeneralizer& g, int u, ScratchVector<Color>& colors, std::vector<std::pair<int, int>>& back_edges,
+                                         const CancellationToken& token, int& discovered) const {
+            if (++discovered % dfs_poll_interval == 0 && token.stop_requested()) return false;
             colors[u] = Color::GRAY;
 
             for (int v : g.outneighbors(u)) {
@@ -586,15 +765,32 @@ public:
                     // This is a back edge, so cycle
                     back_edges.push_back({u, v});
                 } else if (colors[v] == Color::WHITE) {
-                    coloured_dfs_util_recursive(g, v, colors, back_edges);
+                    if (!coloured_dfs_util_recursive(g, v, colors, back_edges, token, discovered)) return false;
                 }
             }
             colors[u] = Color::BLACK;
+            return true;
+        }
+
+        // The finished (BLACK) vertices have no edges to the unfinished ones other than the back edges already found,
+        // and the edges among them follow the finish order. Among the unfinished ones keep the edges going to a higher
+        // index, that order has no cycles.
+        static PartialResult<std::vector<std::pair<int, int>>> partial_back_edges(const GraphTypeImplementationGeneralizer& g, const ScratchVector<Color>& colors,
+                                                                                  std::vector<std::pair<int, int>> back_edges) {
+            std::erase_if(back_edges, [&colors](const auto& edge) { return colors[edge.first] != Color::BLACK; });
+            const int num_vertices = g.numVertices();
+            for (int u = 0; u < num_vertices; ++u) {
+                if (colors[u] == Color::BLACK) continue;
+                for (int v : g.outneighbors(u)) {
+                    if (v <= u && colors[v] != Color::BLACK) back_edges.push_back({u, v});
+                }
+            }
+            return PartialResult<std::vector<std::pair<int, int>>>{std::move(back_edges)};
         }
 
         // Iterative, but slower, as it checks every vertex 2x
-        void coloured_dfs_util(const GraphTypeImplementationGeneralizer& g, int u_start, std::vector<Color>& colors, std::vector<std::pair<int, int>>& back_edges) const {
-            std::vector<int> stack;
+        void coloured_dfs_util(const GraphTypeImplementationGeneralizer& g, int u_start, ScratchVector<Color>& colors, std::vector<std::pair<int, int>>& back_edges) const {
+            ScratchVector<int> stack(colors.get_allocator());
             stack.emplace_back(u_start);
             colors[u_start] = Color::GRAY;
             while (!stack.empty()) {
@@ -633,29 +829,17 @@ public:
         using preferred_graph_properties = GraphProperties::CacheLocal;
         using algorithm_interface = AlgorithmInterface;
         const char* getName() const override { return "4-seq"; }
-        [[deprecated("Very slow")]] AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        [[deprecated("Very slow")]] AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
             if (num_vertices == 0) return -1;
             if (num_vertices == 1) return 0;
+            ExecutionArena arena;
+            ScratchVector<int> dist(num_vertices, -1, &arena);
+            ScratchVector<int> queue(&arena);
+            queue.reserve(num_vertices);
             for (int i = 0; i < num_vertices; ++i) {
-                std::vector<bool> visited(num_vertices, false);
-                std::queue<int> q;
-                int count = 0;
-                q.push(i);
-                visited[i] = true;
-                count++;
-                while (!q.empty()) {
-                    int u = q.front();
-                    q.pop();
-                    for (int v : g.outneighbors(u)) {
-                        if (!visited[v]) {
-                            visited[v] = true;
-                            q.push(v);
-                            count++;
-                        }
-                    }
-                }
-                if (count == num_vertices) return i;
+                token.throw_if_stop_requested();
+                if (bfs_from(g, i, dist, queue).is_connected) return i;
             }
             return -1;
         }
@@ -671,7 +855,7 @@ public:
         using preferred_graph_properties = GraphProperties::CacheLocal;
         using algorithm_interface = AlgorithmInterface;
         const char* getName() const override { return "4-par"; }
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
         if (num_vertices == 0) {
             return -1;
@@ -681,40 +865,32 @@ public:
         }
         // Initialize with num_vertices, which is an invalid index and acts as "infinity".
         std::atomic<int> min_mother_vertex_idx(num_vertices);
-        std::vector<int> indices(num_vertices);
-        std::iota(indices.begin(), indices.end(), 0);
-
-        std::for_each(
-            std::execution::par,
-            indices.begin(),
-            indices.end(),
-            [&](int i) {
-                // Early exit for this vertex
-                if (i >= min_mother_vertex_idx.load(std::memory_order_relaxed)) {
+
+        parallel_for_chunks(
+            0, num_vertices,
+            [&](int chunk_begin, int chunk_end) {
+                // Early exit for the whole chunk, before its buffers are allocated
+                if (chunk_begin >= min_mother_vertex_idx.load(std::memory_order_relaxed)) {
                     return;
                 }
-                std::vector<bool> visited(num_vertices, false);
-                std::queue<int> q;
-                q.push(i);
-                visited[i] = true;
-                int count = 1;
-                while (!q.empty()) {
-                    int u = q.front();
-                    q.pop();
-                    for (int v : g.outneighbors(u)) {
-                        if (!visited[v]) {
-                            visited[v] = true;
-                            q.push(v);
-                            count++;
-                        }
+                ExecutionArena arena;
+                ScratchVector<int> dist(num_vertices, -1, &arena);
+                ScratchVector<int> queue(&arena);
+                queue.reserve(num_vertices);
+                for (int i = chunk_begin; i < chunk_end; ++i) {
+                    // Early exit for this vertex
+                    if (i >= min_mother_vertex_idx.load(std::memory_order_relaxed)) {
+                        return;
                     }
-                }
-                //Atomic Update
-                if (count == num_vertices) {
-                    int expected = min_mother_vertex_idx.load();
-                    while (i < expected) {
-                        if (min_mother_vertex_idx.compare_exchange_weak(expected, i)) {
-                            break; // Success
+                    // reaches the caller through parallel_for_chunks, the other chunks stop at their next vertex
+                    token.throw_if_stop_requested();
+                    //Atomic Update
+                    if (bfs_from(g, i, dist, queue).is_connected) {
+                        int expected = min_mother_vertex_idx.load();
+                        while (i < expected) {
+                            if (min_mother_vertex_idx.compare_exchange_weak(expected, i)) {
+                                break; // Success
+                            }
                         }
                     }
                 }
@@ -735,24 +911,26 @@ public:
             if (isDebugMode) return "4-Kosaraju";
             else return "4";
         }
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
         if (num_vertices == 0) return -1;
         if (num_vertices == 1) return 0;
+        ExecutionArena arena;
         // Kosaraju's First Pass
-        std::vector<int> finish_order;
+        ScratchVector<int> finish_order(&arena);
         finish_order.reserve(num_vertices);
-        std::vector<bool> visited(num_vertices, false);
+        ScratchVector<bool> visited(num_vertices, false, &arena);
         for (int i = 0; i < num_vertices; ++i) {
             if (!visited[i]) {
-                DFS_util(g, i, visited, finish_order);
+                token.throw_if_stop_requested();
+                DFS_util(g, i, visited, finish_order, token);
             }
         }
         // Verify a mother vertex
         int candidate_vertex = finish_order.back();
         std::ranges::fill(visited, false);
-        std::vector<int> reach_count_vec;
-        DFS_util(g, candidate_vertex, visited, reach_count_vec);
+        ScratchVector<int> reach_count_vec(&arena);
+        DFS_util(g, candidate_vertex, visited, reach_count_vec, token);
         if (reach_count_vec.size() != num_vertices) {
             return -1; // No mother vertex
         }
@@ -761,14 +939,15 @@ public:
         // The source SCC is the one containing the 'candidate' vertex.
         GraphTypeImplementationGeneralizer g_transpose = g.getTranspose();
         std::ranges::fill(visited, false);
-        std::vector<std::vector<int>> scc_list;
+        ScratchVector<ScratchVector<int>> scc_list(&arena);
         // Iterate the finish_order vector in reverse to process in the correct order
         for (const int v : std::views::reverse(finish_order)) {
             if (!visited[v]) {
-                std::vector<int> current_scc;
+                token.throw_if_stop_requested();
+                ScratchVector<int> current_scc(&arena);
                 // The DFS for collecting SCCs must be on the TRANSPOSED graph
-                DFS_collect_scc(g_transpose, v, visited, current_scc);
-                scc_list.push_back(current_scc);
+                DFS_collect_scc(g_transpose, v, visited, current_scc, token);
+                scc_list.push_back(std::move(current_scc));
             }
         }
         // Find the source SCC and the minimum element within it
@@ -797,7 +976,7 @@ public:
             else return "4";
         }
 
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
             if (num_vertices == 0) {
                 return -1;
@@ -806,106 +985,10 @@ public:
                 return 0;
             }
 
-            std::vector<int> ids(num_vertices, -1);
-            std::vector<int> low(num_vertices, -1);
-            std::vector<bool> onStack(num_vertices, false);
-            std::vector<int> st;
-            st.reserve(num_vertices);
-
-            std::vector<int> scc_map(num_vertices, -1);
-            int scc_count = 0;
-            int id_counter = 0;
-
-            /*
-            std::function<void(int)> tarjan_dfs =
-                [&](int at) {
-                st.push_back(at);
-                onStack[at] = true;
-                ids[at] = low[at] = id_counter++;
-
-                for (int to : g.outneighbors(at)) {
-                    if (ids[to] == -1) {
-                        tarjan_dfs(to);
-                        low[at] = std::min(low[at], low[to]);
-                    } else if (onStack[to]) {
-                        low[at] = std::min(low[at], ids[to]);
-                    }
-                }
-
-                if (ids[at] == low[at]) {
-                    while (true) {
-                        int node = st.back();
-                        st.pop_back();
-                        onStack[node] = false;
-                        scc_map[node] = scc_count;
-                        if (node == at) break;
-                    }
-                    scc_count++;
-                }
-            };
-
-            for (int i = 0; i < num_vertices; ++i) {
-                if (ids[i] == -1) {
-                    tarjan_dfs(i);
-                }
-            }
-             */
-
-            for (int i = 0; i < num_vertices; ++i) {
-                if (ids[i] == -1) {
-                    auto initial_neighbors = g.outneighbors(i);
-                    using neighbor_iterator = decltype(initial_neighbors.begin());
-                    std::vector<std::tuple<int, neighbor_iterator, neighbor_iterator>> dfs_stack;
-
-                    dfs_stack.emplace_back(i, initial_neighbors.begin(), initial_neighbors.end());
-                    st.push_back(i);
-                    onStack[i] = true;
-                    ids[i] = low[i] = id_counter++;
+            const auto [scc_map, scc_count] = strongly_connected_components(g, token);
 
-                    while(!dfs_stack.empty()) {
-                        auto& [at, it, end_it] = dfs_stack.back();
-
-                        bool pushed_new = false;
-                        while(it != end_it) {
-                            int to = *it;
-                            ++it;
-
-                            if (ids[to] == -1) {
-                                st.push_back(to);
-                                onStack[to] = true;
-                                ids[to] = low[to] = id_counter++;
-                                auto to_neighbors = g.outneighbors(to);
-                                dfs_stack.emplace_back(to, to_neighbors.begin(), to_neighbors.end());
-                                pushed_new = true;
-                                break;
-                            } else if (onStack[to]) {
-                                low[at] = std::min(low[at], ids[to]);
-                            }
-                        }
-
-                        if (!pushed_new) {
-                            if (ids[at] == low[at]) {
-                                while (true) {
-                                    int node = st.back();
-                                    st.pop_back();
-                                    onStack[node] = false;
-                                    scc_map[node] = scc_count;
-                                    if (node == at) break;
-                                }
-                                scc_count++;
-                            }
-
-                            dfs_stack.pop_back();
-                            if(!dfs_stack.empty()) {
-                                auto& [parent, parent_it, parent_end_it] = dfs_stack.back();
-                                low[parent] = std::min(low[parent], low[at]);
-                            }
-                        }
-                    }
-                }
-            }
-
-            std::vector<int> scc_in_degree(scc_count, 0);
+            ExecutionArena arena;
+            ScratchVector<int> scc_in_degree(scc_count, 0, &arena);
             for (int u = 0; u < num_vertices; ++u) {
                 for (int v : g.outneighbors(u)) {
                     if (scc_map[u] != scc_map[v]) {
@@ -939,10 +1022,10 @@ public:
                  return -1;
             }
 
-            std::vector<bool> visited(num_vertices, false);
-            std::vector<int> reach_count_vec;
+            ScratchVector<bool> visited(num_vertices, false, &arena);
+            ScratchVector<int> reach_count_vec(&arena);
             reach_count_vec.reserve(num_vertices);
-            DFS_util(g, candidate_vertex, visited, reach_count_vec);
+            DFS_util(g, candidate_vertex, visited, reach_count_vec, token);
 
             if (reach_count_vec.size() != num_vertices) {
                 return -1;
@@ -970,16 +1053,18 @@ public:
             else return "4";
         }
 
-        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+        AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
             const int num_vertices = g.numVertices();
             if (num_vertices == 0) return -1;
             if (num_vertices == 1) return 0;
 
-            std::vector<int> preorder(num_vertices, 0);
+            ExecutionArena arena;
+            ScratchVector<int> preorder(num_vertices, 0, &arena);
             int preorder_counter = 1; // Start at 1, 0 means unvisited
-            std::vector<int> S; S.reserve(num_vertices);
-            std::vector<int> P; P.reserve(num_vertices);
-            std::vector<int> scc_map(num_vertices, -1);
+            ScratchVector<int> S(&arena); S.reserve(num_vertices);
+            ScratchVector<int> P(&arena); P.reserve(num_vertices);
+            ScratchVector<int> scc_map(num_vertices, -1, &arena);
+            ScratchVector<int> stack(&arena); // empty again after every root
             int scc_count = 0;
 
             /*
@@ -1019,8 +1104,7 @@ public:
 
             for (int i = 0; i < num_vertices; ++i) {
                 if (preorder[i] == 0) {
-                    std::vector<int> stack;
-
+                    token.throw_if_stop_requested();
                     stack.emplace_back(i);
                     preorder[i] = preorder_counter++;
                     S.push_back(i);
@@ -1038,6 +1122,7 @@ public:
                             ++it;
 
                             if (preorder[w] == 0) {
+                                if (preorder_counter % dfs_poll_interval == 0) token.throw_if_stop_requested();
                                 auto w_neighbors = g.outneighbors(w);
                                 stack.emplace_back(w);
                                 preorder[w] = preorder_counter++;
@@ -1069,7 +1154,7 @@ public:
                 }
             }
 
-            std::vector<int> scc_in_degree(scc_count, 0);
+            ScratchVector<int> scc_in_degree(scc_count, 0, &arena);
             for (int u = 0; u < num_vertices; ++u) {
                 for (int v : g.outneighbors(u)) {
                     if (scc_map[u] != scc_map[v]) {
@@ -1103,10 +1188,10 @@ public:
                 return -1;
             }
 
-            std::vector<bool> visited(num_vertices, false);
-            std::vector<int> reach_count_vec;
+            ScratchVector<bool> visited(num_vertices, false, &arena);
+            ScratchVector<int> reach_count_vec(&arena);
             reach_count_vec.reserve(num_vertices);
-            DFS_util(g, candidate_vertex, visited, reach_count_vec);
+            DFS_util(g, candidate_vertex, visited, reach_count_vec, token);
 
             if (reach_count_vec.size() != num_vertices) {
                 return -1;
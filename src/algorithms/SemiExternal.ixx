@@ -0,0 +1,285 @@
+module;
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+export module SemiExternal;
+
+import CsrFile;
+import Cancellation;
+import DegreeKernels;
+
+/**
+ * Algorithms for graphs whose vertex set fits into memory but whose edge set does not. The vertex state (distances,
+ * colors, component ids) is kept in memory, the adjacency is only touched through CsrFile::scan, i.e. as sequential
+ * reads of the lists of the vertices that are active in a round. Every result carries the I/O of its computation.
+ */
+
+export template <typename T>
+struct SemiExternalResult {
+    T value;
+    IoStats io;
+};
+
+export constexpr std::uint32_t unreached = std::numeric_limits<std::uint32_t>::max();
+
+export struct BfsLevels {
+    std::vector<std::uint32_t> dist; // unreached for the vertices not reached
+    std::uint32_t eccentricity = 0;
+    std::uint64_t reached = 0;
+};
+
+// SccDecomposition with the 32 bit vertex ids of CsrFile
+export struct SemiExternalScc {
+    std::vector<std::uint32_t> scc_map; // vertex -> component id
+    std::uint32_t scc_count = 0;
+};
+
+/**
+ * @brief In-degrees straight from the in-memory offsets, no adjacency is read.
+ */
+export SemiExternalResult<std::vector<std::uint64_t>> semi_external_in_degrees(const CsrFile& file) {
+    const auto offsets = file.offsets(Direction::In);
+    std::vector<std::uint64_t> degrees(file.numVertices());
+    for (size_t u = 0; u < degrees.size(); ++u) {
+        degrees[u] = offsets[u + 1] - offsets[u];
+    }
+    return {std::move(degrees), IoStats{}};
+}
+
+/**
+ * @brief Problem 1 on a CSR file: the vertices without incoming edges.
+ */
+export SemiExternalResult<std::vector<std::uint32_t>> semi_external_sources(const CsrFile& file) {
+    const auto [degrees, io] = semi_external_in_degrees(file);
+    return {zero_degree_vertices<std::uint32_t>(std::span<const std::uint64_t>(degrees)), io};
+}
+
+/**
+ * @brief Level synchronous BFS: one scan per level over the lists of that level's vertices only, so every list
+ * is read once and in file order.
+ */
+export SemiExternalResult<BfsLevels> semi_external_bfs(CsrFile& file, std::uint32_t source, Direction direction = Direction::Out,
+                                                       const CancellationToken& token = {}) {
+    if (source >= file.numVertices()) throw std::out_of_range("Invalid vertex index.");
+    const IoStats before = file.io_stats();
+    BfsLevels levels;
+    levels.dist.assign(file.numVertices(), unreached);
+    levels.dist[source] = 0;
+    levels.reached = 1;
+    for (std::uint32_t level = 0;; ++level) {
+        token.throw_if_stop_requested();
+        std::uint64_t discovered = 0;
+        file.scan(direction, [&](std::uint32_t u) { return levels.dist[u] == level; },
+                  [&](std::uint32_t, std::span<const std::uint32_t> neighbors) {
+            for (std::uint32_t v : neighbors) {
+                if (levels.dist[v] == unreached) {
+                    levels.dist[v] = level + 1;
+                    ++discovered;
+                }
+            }
+        });
+        if (discovered == 0) break;
+        levels.reached += discovered;
+        levels.eccentricity = level + 1;
+    }
+    return {std::move(levels), file.io_stats() - before};
+}
+
+/**
+ * @brief Strongly connected iff vertex 0 reaches every vertex forwards and backwards.
+ */
+export SemiExternalResult<bool> semi_external_is_strongly_connected(CsrFile& file, const CancellationToken& token = {}) {
+    if (file.numVertices() <= 1) return {true, IoStats{}};
+    const IoStats before = file.io_stats();
+    const bool forward = semi_external_bfs(file, 0, Direction::Out, token).value.reached == file.numVertices();
+    const bool connected = forward && semi_external_bfs(file, 0, Direction::In, token).value.reached == file.numVertices();
+    return {connected, file.io_stats() - before};
+}
+
+/**
+ * @brief Strongly connected components by coloring (Orzan), every round a few scans:
+ * - trimming: vertices without remaining in- or out-edges are components on their own, layer by layer over a worklist
+ *   of the vertices whose degree dropped to 0, so a path costs O(V + E) and not O(V) per layer,
+ * - every remaining vertex takes the largest id that reaches it (forward scans of the vertices whose color changed),
+ * - a vertex whose color is its own id is the root of a component: the vertices of its color that reach it
+ *   (backward scans from the roots) form that component and are removed.
+ * Component ids are in the order the components are found.
+ */
+export SemiExternalResult<SemiExternalScc> semi_external_scc(CsrFile& file, const CancellationToken& token = {}) {
+    const std::uint32_t num_vertices = file.numVertices();
+    const IoStats before = file.io_stats();
+    constexpr std::uint32_t unassigned = unreached;
+    std::vector<std::uint32_t> component(num_vertices, unassigned);
+    std::uint32_t component_count = 0;
+    std::uint64_t remaining = num_vertices;
+
+    // degrees within the unassigned vertices
+    std::vector<std::uint64_t> in_degree(num_vertices);
+    std::vector<std::uint64_t> out_degree(num_vertices);
+    for (std::uint32_t u = 0; u < num_vertices; ++u) {
+        in_degree[u] = file.degree(Direction::In, u);
+        out_degree[u] = file.degree(Direction::Out, u);
+    }
+
+    std::vector<std::uint32_t> color(num_vertices);
+    std::vector<char> active(num_vertices, 0);
+    std::vector<char> next_active(num_vertices, 0);
+    std::vector<std::uint32_t> component_of_root(num_vertices, unassigned);
+
+    // vertices without remaining in- or out-edges, only the ones whose degree dropped to 0 are added after the start
+    std::vector<std::uint32_t> trimmable;
+    std::vector<char> queued(num_vertices, 0);
+    auto queue_if_trimmable = [&](std::uint32_t v) {
+        if (component[v] == unassigned && !queued[v] && (in_degree[v] == 0 || out_degree[v] == 0)) {
+            queued[v] = 1;
+            trimmable.push_back(v);
+        }
+    };
+    for (std::uint32_t u = 0; u < num_vertices; ++u) {
+        queue_if_trimmable(u);
+    }
+
+    while (remaining > 0) {
+        // trimming, one layer per iteration, the removed vertices' lists are read once to update their neighbors' degrees
+        while (!trimmable.empty()) {
+            token.throw_if_stop_requested();
+            std::vector<std::uint32_t> layer;
+            std::swap(layer, trimmable);
+            std::ranges::sort(layer);
+            for (std::uint32_t u : layer) {
+                component[u] = component_count++;
+            }
+            remaining -= layer.size();
+            file.scan_vertices(Direction::Out, layer, [&](std::uint32_t, std::span<const std::uint32_t> neighbors) {
+                for (std::uint32_t v : neighbors) {
+                    --in_degree[v];
+                    queue_if_trimmable(v);
+                }
+            });
+            file.scan_vertices(Direction::In, layer, [&](std::uint32_t, std::span<const std::uint32_t> neighbors) {
+                for (std::uint32_t v : neighbors) {
+                    --out_degree[v];
+                    queue_if_trimmable(v);
+                }
+            });
+        }
+        if (remaining == 0) break;
+
+        // forward propagation of the largest color
+        for (std::uint32_t u = 0; u < num_vertices; ++u) {
+            active[u] = component[u] == unassigned;
+            color[u] = active[u] ? u : unassigned;
+        }
+        bool changed = true;
+        while (changed) {
+            token.throw_if_stop_requested();
+            changed = false;
+            file.scan(Direction::Out, [&](std::uint32_t u) { return active[u] != 0; },
+                      [&](std::uint32_t u, std::span<const std::uint32_t> neighbors) {
+                for (std::uint32_t v : neighbors) {
+                    if (component[v] == unassigned && color[v] < color[u]) {
+                        color[v] = color[u];
+                        next_active[v] = 1;
+                        changed = true;
+                    }
+                }
+            });
+            std::swap(active, next_active);
+            std::fill(next_active.begin(), next_active.end(), 0);
+        }
+
+        // backward from the roots within their color
+        for (std::uint32_t u = 0; u < num_vertices; ++u) {
+            active[u] = component[u] == unassigned && color[u] == u;
+            if (active[u]) {
+                component_of_root[u] = component_count++;
+                component[u] = component_of_root[u];
+                --remaining;
+            }
+        }
+        changed = true;
+        while (changed) {
+            token.throw_if_stop_requested();
+            changed = false;
+            file.scan(Direction::In, [&](std::uint32_t u) { return active[u] != 0; },
+                      [&](std::uint32_t u, std::span<const std::uint32_t> neighbors) {
+                for (std::uint32_t w : neighbors) {
+                    if (component[w] == unassigned && color[w] == color[u]) {
+                        component[w] = component_of_root[color[u]];
+                        next_active[w] = 1;
+                        --remaining;
+                        changed = true;
+                    }
+                }
+            });
+            std::swap(active, next_active);
+            std::fill(next_active.begin(), next_active.end(), 0);
+        }
+
+        // the vertices assigned in this round (they still have a color) no longer count towards the degrees of the others
+        if (remaining == 0) break;
+        auto assigned_now = [&](std::uint32_t u) { return component[u] != unassigned && color[u] != unassigned; };
+        file.scan(Direction::Out, assigned_now, [&](std::uint32_t, std::span<const std::uint32_t> neighbors) {
+            for (std::uint32_t v : neighbors) {
+                --in_degree[v];
+                queue_if_trimmable(v);
+            }
+        });
+        file.scan(Direction::In, assigned_now, [&](std::uint32_t, std::span<const std::uint32_t> neighbors) {
+            for (std::uint32_t v : neighbors) {
+                --out_degree[v];
+                queue_if_trimmable(v);
+            }
+        });
+    }
+
+    return {SemiExternalScc{std::move(component), component_count}, file.io_stats() - before};
+}
+
+std::ostream& operator<<(std::ostream& out, const IoStats& io) {
+    return out << "io: " << io.bytes_read << " bytes in " << io.block_reads << " reads, " << io.scans << " scans";
+}
+
+/**
+ * @brief --semi-external <file>: runs the semi-external algorithms on a CSR file. A text graph is converted to
+ * <file>.csr first.
+ */
+export template <bool isDebugMode>
+int runSemiExternalMode(const std::string& graph_path, std::ostream& out = std::cout) {
+    std::string csr_path = graph_path;
+    try {
+        if (!is_csr_file(graph_path)) {
+            csr_path = graph_path + ".csr";
+            if constexpr (isDebugMode) std::cerr << "[DEBUG] Converting " << graph_path << " to " << csr_path << std::endl;
+            convert_text_to_csr(graph_path, csr_path);
+        }
+        CsrFile file(csr_path);
+        out << "Vertices: " << file.numVertices() << ", edges: " << file.numEdges() << "\n";
+
+        const auto sources = semi_external_sources(file);
+        out << "Sources: " << sources.value.size() << " (" << sources.io << ")\n";
+        const auto connected = semi_external_is_strongly_connected(file);
+        out << "Strongly connected: " << (connected.value ? "true" : "false") << " (" << connected.io << ")\n";
+        const auto scc = semi_external_scc(file);
+        out << "Strongly connected components: " << scc.value.scc_count << " (" << scc.io << ")\n";
+        if (file.numVertices() > 0) {
+            const auto bfs = semi_external_bfs(file, 0);
+            out << "BFS from 0: reached " << bfs.value.reached << ", eccentricity " << bfs.value.eccentricity
+                << " (" << bfs.io << ")\n";
+        }
+        out << "Total " << file.io_stats() << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Semi-external mode failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
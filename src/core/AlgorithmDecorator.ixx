@@ -14,6 +14,7 @@ import GraphConcepts;
 import ImplementedGraph;
 import GraphPropertySelector;
 import Properties;
+import Cancellation;
 
 export template <IsGraph GraphTypeImplementationGeneralizer = ImplementedGraph,
                  typename AlgorithmInterface = IAlgorithm<GraphTypeImplementationGeneralizer>>
@@ -30,11 +31,11 @@ public:
         return wrapped_algo->getName();
     }
 
-    AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+    AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
         std::cout << "" << getName() << ":" << std::endl;
         const auto start = std::chrono::steady_clock::now();
 
-        auto result = wrapped_algo->execute(g);
+        auto result = wrapped_algo->execute(g, token);
 
         const auto finish = std::chrono::steady_clock::now();
         const std::chrono::duration<double> elapsed = finish - start;
@@ -66,7 +67,8 @@ public:
             }
             constexpr bool is_supported =
                 (std::is_same_v<PreferredProperty, GraphProperties::CacheLocal> && GraphTypeImplementationGeneralizer::is_cache_local::value) ||
-                (std::is_same_v<PreferredProperty, GraphProperties::EasilyMutable> && GraphTypeImplementationGeneralizer::is_easily_mutable::value);
+                (std::is_same_v<PreferredProperty, GraphProperties::EasilyMutable> && GraphTypeImplementationGeneralizer::is_easily_mutable::value) ||
+                (std::is_same_v<PreferredProperty, GraphProperties::DegreeAdaptive> && GraphTypeImplementationGeneralizer::is_degree_adaptive::value);
 
             if constexpr (is_supported) {
                 using TargetGraphType = typename GraphImplementationPropertyProviderSelector<
@@ -84,8 +86,8 @@ public:
         return wrapped_algo->getName();
     }
 
-    AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const override {
+    AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const override {
         conversion_fn(g);
-        return wrapped_algo->execute(g);
+        return wrapped_algo->execute(g, token);
     }
 };
\ No newline at end of file
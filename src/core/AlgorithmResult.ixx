@@ -11,10 +11,25 @@ module;
 #include <utility>
 #include <variant>
 #include <ranges>
+#include <sstream>
 
 export module AlgorithmResult;
 
-export using AlgoResultVariant = std::variant<int, std::vector<int>, std::string, std::vector<std::pair<int, int>>>;
+// best result an anytime strategy had when it was cancelled: a lower bound for the diameter, a valid but not
+// necessarily minimal feedback arc set
+export template <typename T>
+struct PartialResult {
+    T value;
+    bool operator==(const PartialResult&) const = default;
+};
+
+export using AlgoResultVariant = std::variant<int, std::vector<int>, std::string, std::vector<std::pair<int, int>>,
+                                              PartialResult<int>, PartialResult<std::vector<std::pair<int, int>>>>;
+
+export bool isPartial(const AlgoResultVariant& result) {
+    return std::holds_alternative<PartialResult<int>>(result)
+        || std::holds_alternative<PartialResult<std::vector<std::pair<int, int>>>>(result);
+}
 
 template <typename stream_type>
 concept OutputStreamable = requires(stream_type& os, const std::string value) {
@@ -41,7 +56,48 @@ void printResult(const AlgoResultVariant& result, OS& os = std::cout) {
     else if (std::holds_alternative<std::string>(result)) {
         os << std::get<std::string>(result) << std::endl;
     }
+    else if (std::holds_alternative<PartialResult<int>>(result)) {
+        os << std::get<PartialResult<int>>(result).value << " (partial)" << std::endl;
+    }
+    else if (std::holds_alternative<PartialResult<std::vector<std::pair<int, int>>>>(result)) {
+        const auto& vec = std::get<PartialResult<std::vector<std::pair<int, int>>>>(result).value;
+        os << "(partial)\n";
+        for (const auto& [key, value] : vec) {
+            os << key << " " << value << "\n";
+        }
+    }
     else {
         os << "unexpected type, cannot print" << std::endl;
     }
-}
\ No newline at end of file
+}
+
+// single line form of a result, for line based protocols: vectors are written as their size followed by the elements
+export std::string formatResultLine(const AlgoResultVariant& result) {
+    std::ostringstream os;
+    if (std::holds_alternative<int>(result)) {
+        os << std::get<int>(result);
+    } else if (std::holds_alternative<std::vector<int>>(result)) {
+        const auto& vec = std::get<std::vector<int>>(result);
+        os << vec.size();
+        for (const int value : vec) {
+            os << " " << value;
+        }
+    } else if (std::holds_alternative<std::vector<std::pair<int, int>>>(result)) {
+        const auto& vec = std::get<std::vector<std::pair<int, int>>>(result);
+        os << vec.size();
+        for (const auto& [key, value] : vec) {
+            os << " " << key << " " << value;
+        }
+    } else if (std::holds_alternative<std::string>(result)) {
+        os << std::get<std::string>(result);
+    } else if (std::holds_alternative<PartialResult<int>>(result)) {
+        os << "partial " << std::get<PartialResult<int>>(result).value;
+    } else if (std::holds_alternative<PartialResult<std::vector<std::pair<int, int>>>>(result)) {
+        const auto& vec = std::get<PartialResult<std::vector<std::pair<int, int>>>>(result).value;
+        os << "partial " << vec.size();
+        for (const auto& [key, value] : vec) {
+            os << " " << key << " " << value;
+        }
+    }
+    return os.str();
+}
@@ -0,0 +1,64 @@
+module;
+
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+
+export module Cancellation;
+
+/**
+ * @brief Thrown by exact strategies that were cancelled before they had a result.
+ */
+export class OperationCancelled : public std::runtime_error {
+public:
+    OperationCancelled() : std::runtime_error("Operation cancelled.") {}
+};
+
+/**
+ * @brief Asks a running algorithm to stop, either through a std::stop_source or once a deadline has passed.
+ *
+ * A default constructed token never stops. Algorithms poll stop_requested() at frontier or chunk boundaries,
+ * so a stop takes effect within one BFS / DFS pass, not immediately.
+ */
+export class CancellationToken {
+public:
+    using clock = std::chrono::steady_clock;
+
+private:
+    std::stop_token stop;
+    std::optional<clock::time_point> deadline;
+
+public:
+    CancellationToken() = default;
+
+    explicit CancellationToken(std::stop_token stop_token, std::optional<clock::time_point> deadline_at = std::nullopt)
+        : stop(std::move(stop_token)), deadline(deadline_at) {}
+
+    static CancellationToken at(clock::time_point deadline_at) {
+        return CancellationToken(std::stop_token{}, deadline_at);
+    }
+
+    static CancellationToken after(clock::duration timeout) {
+        return at(clock::now() + timeout);
+    }
+
+    // same stop source, the earlier of the two deadlines
+    CancellationToken with_deadline(clock::time_point deadline_at) const {
+        if (deadline && *deadline < deadline_at) return *this;
+        return CancellationToken(stop, deadline_at);
+    }
+
+    bool can_be_stopped() const {
+        return stop.stop_possible() || deadline.has_value();
+    }
+
+    bool stop_requested() const {
+        if (stop.stop_requested()) return true;
+        return deadline && clock::now() >= *deadline;
+    }
+
+    void throw_if_stop_requested() const {
+        if (stop_requested()) throw OperationCancelled();
+    }
+};
@@ -3,22 +3,48 @@ module;
 #include  <span>
 #include  <concepts>
 #include  <variant>
+#include  <cstdint>
+#include  <limits>
 
 export module GraphConcepts;
 
+// vertex ids are stored as-is in the adjacency arrays, so a narrow type halves the bandwidth of every traversal
+export template <typename T>
+concept VertexIndex = std::integral<T> && !std::same_as<T, bool>;
+
+// edge offsets and edge counts; has to be wide enough for numEdges()
+export template <typename T>
+concept EdgeIndex = std::integral<T> && !std::same_as<T, bool>;
+
 export template <typename G>
-concept IsGraph = requires(G g, const G& cg, int u, int v) {
-    { cg.numVertices() } -> std::same_as<int>;
-    { cg.numEdges() } -> std::same_as<int>;
+concept IsGraph = requires {
+    typename G::vertex_type;
+    typename G::edge_offset_type;
+} && requires(G g, const G& cg, typename G::vertex_type u, typename G::vertex_type v) {
+    { cg.numVertices() } -> std::same_as<typename G::vertex_type>;
+    { cg.numEdges() } -> std::same_as<typename G::edge_offset_type>;
     { g.addEdge(u, v) } -> std::same_as<void>;
     { g.removeEdge(u, v) } -> std::same_as<void>;
-    { cg.outneighbors(u) } -> std::same_as<std::span<const int>>;
-    { cg.inneighbors(u) } -> std::same_as<std::span<const int>>;
-    { cg.out_degree(u) } -> std::same_as<int>;
-    { cg.in_degree(u) } -> std::same_as<int>;
+    { cg.outneighbors(u) } -> std::same_as<std::span<const typename G::vertex_type>>;
+    { cg.inneighbors(u) } -> std::same_as<std::span<const typename G::vertex_type>>;
+    { cg.out_degree(u) } -> std::same_as<typename G::edge_offset_type>;
+    { cg.in_degree(u) } -> std::same_as<typename G::edge_offset_type>;
+    { cg.out_degrees() } -> std::same_as<std::span<const typename G::edge_offset_type>>;
+    { cg.in_degrees() } -> std::same_as<std::span<const typename G::edge_offset_type>>;
+    { cg.has_edge(u, v) } -> std::same_as<bool>;
     { cg.getTranspose() } -> std::same_as<G>;
 };
 
+/**
+ * @brief True if a graph with the given vertex and edge count can be represented with the given index types.
+ * numVertices() returns a VertexId, so the vertex count itself has to fit, not just the largest id.
+ */
+export template <VertexIndex VertexId, EdgeIndex EdgeOffset>
+constexpr bool index_types_fit(std::uint64_t num_vertices, std::uint64_t num_edges) {
+    return num_vertices <= static_cast<std::uint64_t>(std::numeric_limits<VertexId>::max())
+        && num_edges <= static_cast<std::uint64_t>(std::numeric_limits<EdgeOffset>::max());
+}
+
 template<typename T, typename Variant>
 struct is_in_variant;
 
@@ -26,4 +52,4 @@ template<typename T, typename... Types>
 struct is_in_variant<T, std::variant<Types...>> : std::disjunction<std::is_same<T, Types>...> {};
 
 export template<typename T, typename Variant>
-concept IsVariantMember = is_in_variant<T, Variant>::value;
\ No newline at end of file
+concept IsVariantMember = is_in_variant<T, Variant>::value;
@@ -18,6 +18,10 @@ namespace detail {
     struct graph_has_property<G, GraphProperties::EasilyMutable> {
         static constexpr bool value = G::is_easily_mutable::value;
     };
+    template <typename G>
+    struct graph_has_property<G, GraphProperties::DegreeAdaptive> {
+        static constexpr bool value = G::is_degree_adaptive::value;
+    };
 
     template <typename P, typename Variant, std::size_t I = 0>
     struct find_first_graph_with_property {
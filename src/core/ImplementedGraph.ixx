@@ -9,19 +9,26 @@ module;
 #include <typeindex>
 #include <concepts>
 #include <type_traits>
+#include <cstdint>
+#include <memory_resource>
 
 import GraphConcepts;
 import IGraph;
 import GraphNList;
 import GraphFList;
 import GraphAMatrix;
+import GraphHybrid;
 
 //intends to provide something like pimpl, so the algos can work on ImplementedGraph-s,
 //and the factory can take the desired graph implementation type as a template param and return an ImplementedGraph wrapping that type
 
 export module ImplementedGraph;
 
-using GraphVariant = std::variant<GraphNList, GraphFList, GraphAMatrix>;
+template <VertexIndex VertexId, EdgeIndex EdgeOffset>
+using BasicGraphVariant = std::variant<BasicGraphNList<VertexId, EdgeOffset>,
+                                       BasicGraphFList<VertexId, EdgeOffset>,
+                                       BasicGraphAMatrix<VertexId, EdgeOffset>,
+                                       BasicGraphHybrid<VertexId, EdgeOffset>>;
 
 namespace traitdetector {
     template <typename G>
@@ -33,6 +40,11 @@ namespace traitdetector {
     concept HasEasilyMutableTrait = requires { { G::is_easily_mutable::value } -> std::same_as<const bool&>; };
     template<typename G>
     struct get_is_easily_mutable : std::bool_constant<HasEasilyMutableTrait<G> ? G::is_easily_mutable::value : false> {};
+
+    template <typename G>
+    concept HasDegreeAdaptiveTrait = requires { { G::is_degree_adaptive::value } -> std::same_as<const bool&>; };
+    template<typename G>
+    struct get_is_degree_adaptive : std::bool_constant<HasDegreeAdaptiveTrait<G> ? G::is_degree_adaptive::value : false> {};
     template <typename Variant, template<typename> typename Predicate, size_t I = 0>
     consteval bool any_type_satisfies() {
         if constexpr (I >= std::variant_size_v<Variant>) {
@@ -48,32 +60,45 @@ namespace traitdetector {
     }
 }
 
-export class ImplementedGraph : public IGraph {
+export template <VertexIndex VertexId = int, EdgeIndex EdgeOffset = int>
+class BasicImplementedGraph : public BasicIGraph<VertexId, EdgeOffset> {
+    using GraphVariant = BasicGraphVariant<VertexId, EdgeOffset>;
 private:
     mutable GraphVariant graph_impl;
     mutable std::map<std::type_index, GraphVariant> stashed_graph_impls;
 public:
-    using graph_variant = ::GraphVariant;
-    using graph_interface = IGraph;
+    using graph_variant = GraphVariant;
+    using graph_interface = BasicIGraph<VertexId, EdgeOffset>;
+    using vertex_type = VertexId;
+    using edge_offset_type = EdgeOffset;
 
     using is_cache_local = std::bool_constant<traitdetector::any_type_satisfies<GraphVariant, traitdetector::get_is_cache_local>()>;
     using is_easily_mutable = std::bool_constant<traitdetector::any_type_satisfies<GraphVariant, traitdetector::get_is_easily_mutable>()>;
+    using is_degree_adaptive = std::bool_constant<traitdetector::any_type_satisfies<GraphVariant, traitdetector::get_is_degree_adaptive>()>;
 
     template <IsGraph G>
-    explicit ImplementedGraph(G&& graph) requires std::constructible_from<GraphVariant, G&&>
-    && std::is_base_of_v<IGraph, G> && IsVariantMember<G, GraphVariant>
-        : IGraph(), graph_impl(std::forward<G>(graph)), stashed_graph_impls() {}
-
-    ImplementedGraph(const ImplementedGraph &) = default;
-    ImplementedGraph(ImplementedGraph &&) = default;
-    ImplementedGraph &operator=(const ImplementedGraph &) = default;
-    ImplementedGraph &operator=(ImplementedGraph &&) = default;
+    explicit BasicImplementedGraph(G&& graph) requires std::constructible_from<GraphVariant, G&&>
+    && std::is_base_of_v<graph_interface, G> && IsVariantMember<G, GraphVariant>
+        : graph_interface(), graph_impl(std::forward<G>(graph)), stashed_graph_impls() {}
+
+    // the stash is only a cache of earlier conversions, a copy takes the active representation alone
+    BasicImplementedGraph(const BasicImplementedGraph& other)
+        : graph_interface(), graph_impl(other.graph_impl), stashed_graph_impls() {}
+    BasicImplementedGraph(BasicImplementedGraph &&) = default;
+    BasicImplementedGraph &operator=(const BasicImplementedGraph& other) {
+        if (this != &other) {
+            graph_impl = other.graph_impl;
+            stashed_graph_impls.clear();
+        }
+        return *this;
+    }
+    BasicImplementedGraph &operator=(BasicImplementedGraph &&) = default;
 
     //converts graph in place
     template <IsGraph NewGraphImplementationType>
     void convertTo() const
     requires std::constructible_from<GraphVariant, NewGraphImplementationType&&>
-    && std::is_base_of_v<IGraph, NewGraphImplementationType> && IsVariantMember<NewGraphImplementationType, GraphVariant>
+    && std::is_base_of_v<graph_interface, NewGraphImplementationType> && IsVariantMember<NewGraphImplementationType, GraphVariant>
     {
         // if NewGraphImplementationType == current implementation: return early
         if (std::holds_alternative<NewGraphImplementationType>(graph_impl)) {
@@ -90,10 +115,10 @@ public:
             graph_impl = it->second;
             return;
         }
-        //lookup failed
+        //lookup failed, the new implementation stays on the memory resource of the current one
         graph_impl = std::visit(
             [](const auto& concrete_graph) {
-                return GraphVariant(NewGraphImplementationType(concrete_graph));
+                return GraphVariant(NewGraphImplementationType(concrete_graph, concrete_graph.get_memory_resource()));
             },
             graph_impl
         );
@@ -103,53 +128,78 @@ public:
         return graph_impl;
     }
 
-    int numVertices() const override {
+    std::pmr::memory_resource* get_memory_resource() const {
+        return std::visit([](const auto& g) { return g.get_memory_resource(); }, graph_impl);
+    }
+
+    VertexId numVertices() const override {
         return std::visit([](const auto& g) { return g.numVertices(); }, graph_impl);
     }
 
-    int numEdges() const override {
+    EdgeOffset numEdges() const override {
         return std::visit([](const auto& g) { return g.numEdges(); }, graph_impl);
     }
 
-    void addEdge(int u, int v) override {
+    void addEdge(VertexId u, VertexId v) override {
         stashed_graph_impls.clear();
         std::visit([=](auto& g) { g.addEdge(u, v); }, graph_impl);
     }
 
-    void removeEdge(int u, int v) override {
+    void removeEdge(VertexId u, VertexId v) override {
         stashed_graph_impls.clear();
         std::visit([=](auto& g) { g.removeEdge(u, v); }, graph_impl);
     }
 
-    std::span<const int> outneighbors(int u) const override {
+    std::span<const VertexId> outneighbors(VertexId u) const override {
         return std::visit([=](const auto& g) { return g.outneighbors(u); }, graph_impl);
     }
 
-    std::span<const int> inneighbors(int u) const override {
+    std::span<const VertexId> inneighbors(VertexId u) const override {
         return std::visit([=](const auto& g) { return g.inneighbors(u); }, graph_impl);
     }
 
-    int out_degree(int u) const override {
+    EdgeOffset out_degree(VertexId u) const override {
         return std::visit([=](const auto& g) { return g.out_degree(u); }, graph_impl);
     }
 
-    int in_degree(int u) const override {
+    EdgeOffset in_degree(VertexId u) const override {
         return std::visit([=](const auto& g) { return g.in_degree(u); }, graph_impl);
     }
 
-    ImplementedGraph getTranspose() const {
+    std::span<const EdgeOffset> out_degrees() const override {
+        return std::visit([](const auto& g) { return g.out_degrees(); }, graph_impl);
+    }
+
+    std::span<const EdgeOffset> in_degrees() const override {
+        return std::visit([](const auto& g) { return g.in_degrees(); }, graph_impl);
+    }
+
+    bool has_edge(VertexId u, VertexId v) const override {
+        return std::visit([=](const auto& g) { return g.has_edge(u, v); }, graph_impl);
+    }
+
+    BasicImplementedGraph getTranspose() const {
         return std::visit(
             [](const auto& g) {
-                return ImplementedGraph(g.getTranspose());
+                return BasicImplementedGraph(g.getTranspose());
             }, graph_impl);
     }
 };
 
-export std::ostream& operator<<(std::ostream& ostream, const ImplementedGraph& g) {
-    for (int i = 0; i < g.numVertices(); ++i) {
-        ostream << i << " -> [ ";
-        for (int neighbor : g.outneighbors(i)) {
-            ostream << neighbor << " ";
+export using ImplementedGraph = BasicImplementedGraph<int, int>;
+
+// narrow instantiations, see NarrowestGraphFactory
+export using ImplementedGraph16 = BasicImplementedGraph<std::uint16_t, std::uint32_t>;
+export using ImplementedGraph32 = BasicImplementedGraph<std::uint32_t, std::uint32_t>;
+// more than 2^32 edges on fewer than 2^32 vertices, the adjacency keeps 4 byte ids
+export using ImplementedGraph32E64 = BasicImplementedGraph<std::uint32_t, std::uint64_t>;
+
+export template <VertexIndex VertexId, EdgeIndex EdgeOffset>
+std::ostream& operator<<(std::ostream& ostream, const BasicImplementedGraph<VertexId, EdgeOffset>& g) {
+    for (VertexId i = 0; i < g.numVertices(); ++i) {
+        ostream << +i << " -> [ ";
+        for (VertexId neighbor : g.outneighbors(i)) {
+            ostream << +neighbor << " ";
         }
         ostream << "]" << std::endl;
     }
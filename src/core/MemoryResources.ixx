@@ -0,0 +1,179 @@
+module;
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+export module MemoryResources;
+
+/**
+ * Memory resources for graph storage and for the scratch memory of the algorithms.
+ *
+ * The graph representations keep their storage in std::pmr containers on the resource given to their constructor
+ * (std::pmr::get_default_resource() if none), copies and conversions stay on the resource of their source.
+ * Every GraphProcessor strategy allocates its scratch memory from an ExecutionArena: a monotonic buffer that only
+ * ever bumps a pointer and is released in one step when execute() returns. The arenas get their blocks from
+ * scratch_upstream(), so the profiler can swap the allocator of all scratch memory inside one process.
+ */
+
+export template <typename T>
+using ScratchVector = std::pmr::vector<T>;
+
+/**
+ * @brief Large blocks are mapped on their own and advised to use transparent huge pages, which cuts the TLB misses
+ * of traversals over big adjacency arrays. Smaller blocks go to the upstream resource. Thread-safe if the upstream is.
+ * Without Linux everything goes upstream.
+ */
+export class HugePageResource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t huge_page_size = size_t{2} << 20;
+
+    explicit HugePageResource(size_t min_mapped_bytes = huge_page_size,
+                              std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : min_mapped_bytes(min_mapped_bytes), upstream(upstream) {}
+
+    HugePageResource(const HugePageResource&) = delete;
+    HugePageResource& operator=(const HugePageResource&) = delete;
+
+    // bytes currently mapped, in whole huge pages
+    size_t mapped_bytes() const {
+        return mapped.load(std::memory_order_relaxed);
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+#ifdef __linux__
+        if (is_mapped(bytes, alignment)) {
+            const size_t length = mapped_length(bytes);
+            // one extra huge page, so the block can start on a huge page boundary
+            void* region = mmap(nullptr, length + huge_page_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (region == MAP_FAILED) throw std::bad_alloc();
+            const auto address = reinterpret_cast<std::uintptr_t>(region);
+            const std::uintptr_t aligned = (address + huge_page_size - 1) & ~(std::uintptr_t{huge_page_size} - 1);
+            if (aligned != address) munmap(region, aligned - address);
+            if (const size_t tail = huge_page_size - (aligned - address); tail != 0) {
+                munmap(reinterpret_cast<void*>(aligned + length), tail);
+            }
+            madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);
+            mapped.fetch_add(length, std::memory_order_relaxed);
+            return reinterpret_cast<void*>(aligned);
+        }
+#endif
+        return upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+#ifdef __linux__
+        if (is_mapped(bytes, alignment)) {
+            const size_t length = mapped_length(bytes);
+            munmap(p, length);
+            mapped.fetch_sub(length, std::memory_order_relaxed);
+            return;
+        }
+#endif
+        upstream->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    size_t min_mapped_bytes;
+    std::pmr::memory_resource* upstream;
+    std::atomic<size_t> mapped{0};
+
+    // decided on the size alone, so deallocate takes the same path as allocate
+    bool is_mapped(size_t bytes, size_t alignment) const {
+        return bytes >= min_mapped_bytes && alignment <= huge_page_size;
+    }
+
+    static size_t mapped_length(size_t bytes) {
+        return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+};
+
+/**
+ * @brief Forwards to the upstream resource and counts the bytes it hands out. Thread-safe if the upstream is.
+ */
+export class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream(upstream) {}
+
+    CountingResource(const CountingResource&) = delete;
+    CountingResource& operator=(const CountingResource&) = delete;
+
+    size_t bytes_in_use() const { return in_use.load(std::memory_order_relaxed); }
+    size_t peak_bytes() const { return peak.load(std::memory_order_relaxed); }
+    size_t allocations() const { return allocation_count.load(std::memory_order_relaxed); }
+
+    // starts a new measurement, the peak drops to the bytes still in use
+    void reset_peak() {
+        peak.store(in_use.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        allocation_count.store(0, std::memory_order_relaxed);
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* p = upstream->allocate(bytes, alignment);
+        const size_t now = in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t previous_peak = peak.load(std::memory_order_relaxed);
+        while (now > previous_peak && !peak.compare_exchange_weak(previous_peak, now, std::memory_order_relaxed)) {}
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        return p;
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        upstream->deallocate(p, bytes, alignment);
+        in_use.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+private:
+    std::pmr::memory_resource* upstream;
+    std::atomic<size_t> in_use{0};
+    std::atomic<size_t> peak{0};
+    std::atomic<size_t> allocation_count{0};
+};
+
+std::atomic<std::pmr::memory_resource*> scratch_upstream_resource{nullptr};
+
+/**
+ * @brief The resource every ExecutionArena gets its blocks from, new/delete unless set otherwise.
+ */
+export std::pmr::memory_resource* scratch_upstream() {
+    std::pmr::memory_resource* resource = scratch_upstream_resource.load(std::memory_order_acquire);
+    return resource != nullptr ? resource : std::pmr::new_delete_resource();
+}
+
+/**
+ * @brief Sets the upstream of the arenas created from now on, nullptr restores new/delete.
+ * Parallel strategies create arenas on every worker, so the resource has to be thread-safe and has to outlive them.
+ */
+export void set_scratch_upstream(std::pmr::memory_resource* resource) {
+    scratch_upstream_resource.store(resource, std::memory_order_release);
+}
+
+/**
+ * @brief Scratch memory of one execute() call (or of one parallel task), freed at once on destruction.
+ * Not thread-safe: every task that allocates concurrently needs its own arena.
+ */
+export class ExecutionArena : public std::pmr::monotonic_buffer_resource {
+public:
+    ExecutionArena() : std::pmr::monotonic_buffer_resource(scratch_upstream()) {}
+
+    ExecutionArena(const ExecutionArena&) = delete;
+    ExecutionArena& operator=(const ExecutionArena&) = delete;
+};
@@ -5,6 +5,8 @@ export namespace GraphProperties {
 
     struct EasilyMutable {};
 
+    struct DegreeAdaptive {};
+
     struct NoPreference {};
 }
 
@@ -3,6 +3,7 @@ module;
 #include <type_traits>
 #include <memory>
 #include <iostream>
+#include <cstdint>
 
 export module StrategySelector;
 
@@ -23,8 +24,8 @@ class StrategySelector {
 private:
     static bool is_dense(const GraphTypeImplementationGeneralizer& g) {
         if (g.numVertices() == 0) return false;
-        int v = g.numVertices();
-        int e = g.numEdges();
+        const auto v = static_cast<std::uint64_t>(g.numVertices());
+        const auto e = static_cast<std::uint64_t>(g.numEdges());
         // Heuristic
         return e > (v * v / 4);
     }
@@ -86,9 +87,9 @@ private:
     };
 
 
-public:
-    template <typename Problem, bool isDebugMode = false>
-    static AlgoResultVariant solve(const GraphTypeImplementationGeneralizer& g) {
+    // picks the strategy for Problem and builds it with make_algorithm.template operator()<Algorithm>()
+    template <typename Problem, bool isDebugMode, typename MakeAlgorithm>
+    static std::unique_ptr<AlgorithmInterface> dispatch(const GraphTypeImplementationGeneralizer& g, MakeAlgorithm make_algorithm) {
         using Processor = GraphProcessor<GraphTypeImplementationGeneralizer, AlgorithmInterface, isDebugMode>;
 
         using dense_prop = AlgorithmProperties::DenseGraphPreferred;
@@ -101,35 +102,52 @@ public:
             using no_pref_match = typename find_no_preference_match<Problem, Algorithms...>::type;
 
             if constexpr (!std::is_same_v<perfect_match, void>) {
-                 auto decorated_algo = make_decorated_algorithm<perfect_match>();
-                 if (isDebugMode) std::cout << "[StrategySelector] Selected dense strategy: " << decorated_algo->getName() << std::endl;
-                 return decorated_algo->execute(g);
+                 auto algo = make_algorithm.template operator()<perfect_match>();
+                 if (isDebugMode) std::cout << "[StrategySelector] Selected dense strategy: " << algo->getName() << std::endl;
+                 return algo;
             } else if constexpr (!std::is_same_v<no_pref_match, void>) {
-                auto decorated_algo = make_decorated_algorithm<no_pref_match>();
-                if (isDebugMode) std::cout << "[StrategySelector] Selected no-preference strategy for dense graph: " << decorated_algo->getName() << std::endl;
-                return decorated_algo->execute(g);
+                auto algo = make_algorithm.template operator()<no_pref_match>();
+                if (isDebugMode) std::cout << "[StrategySelector] Selected no-preference strategy for dense graph: " << algo->getName() << std::endl;
+                return algo;
             } else {
-                auto decorated_algo = make_decorated_algorithm<fallback_algo>();
-                if (isDebugMode) std::cout << "[StrategySelector] Selected fallback strategy for dense graph: " << decorated_algo->getName() << std::endl;
-                return decorated_algo->execute(g);
+                auto algo = make_algorithm.template operator()<fallback_algo>();
+                if (isDebugMode) std::cout << "[StrategySelector] Selected fallback strategy for dense graph: " << algo->getName() << std::endl;
+                return algo;
             }
         } else { // Sparse
             using perfect_match = typename find_perfect_match<Problem, sparse_prop, Algorithms...>::type;
             using no_pref_match = typename find_no_preference_match<Problem, Algorithms...>::type;
 
             if constexpr (!std::is_same_v<perfect_match, void>) {
-                auto decorated_algo = make_decorated_algorithm<perfect_match>();
-                if (isDebugMode) std::cout << "[StrategySelector] Selected sparse strategy: " << decorated_algo->getName() << std::endl;
-                return decorated_algo->execute(g);
+                auto algo = make_algorithm.template operator()<perfect_match>();
+                if (isDebugMode) std::cout << "[StrategySelector] Selected sparse strategy: " << algo->getName() << std::endl;
+                return algo;
             } else if constexpr (!std::is_same_v<no_pref_match, void>) {
-                auto decorated_algo = make_decorated_algorithm<no_pref_match>();
-                if (isDebugMode) std::cout << "[StrategySelector] Selected no-preference strategy for sparse graph: " << decorated_algo->getName() << std::endl;
-                return decorated_algo->execute(g);
+                auto algo = make_algorithm.template operator()<no_pref_match>();
+                if (isDebugMode) std::cout << "[StrategySelector] Selected no-preference strategy for sparse graph: " << algo->getName() << std::endl;
+                return algo;
             } else {
-                auto decorated_algo = make_decorated_algorithm<fallback_algo>();
-                if (isDebugMode) std::cout << "[StrategySelector] Selected fallback strategy for sparse graph: " << decorated_algo->getName() << std::endl;
-                return decorated_algo->execute(g);
+                auto algo = make_algorithm.template operator()<fallback_algo>();
+                if (isDebugMode) std::cout << "[StrategySelector] Selected fallback strategy for sparse graph: " << algo->getName() << std::endl;
+                return algo;
             }
         }
     }
+
+public:
+    template <typename Problem, bool isDebugMode = false>
+    static AlgoResultVariant solve(const GraphTypeImplementationGeneralizer& g) {
+        auto decorated_algo = dispatch<Problem, isDebugMode>(g, []<typename Algorithm>() {
+            return make_decorated_algorithm<Algorithm>();
+        });
+        return decorated_algo->execute(g);
+    }
+
+    // undecorated: no timing output and no in-place conversion, so concurrent readers of g can share it
+    template <typename Problem, bool isDebugMode = false>
+    static std::unique_ptr<AlgorithmInterface> select(const GraphTypeImplementationGeneralizer& g) {
+        return dispatch<Problem, isDebugMode>(g, []<typename Algorithm>() -> std::unique_ptr<AlgorithmInterface> {
+            return std::make_unique<Algorithm>();
+        });
+    }
 };
\ No newline at end of file
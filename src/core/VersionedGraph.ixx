@@ -0,0 +1,213 @@
+module;
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+export module VersionedGraph;
+
+import GraphConcepts;
+import ImplementedGraph;
+
+/**
+ * @brief Ordered list of edge insertions and removals, applied as one version by VersionedGraph::apply().
+ */
+export template <VertexIndex VertexId = int>
+class EdgeBatch {
+public:
+    enum class Kind { Add, Remove };
+
+    struct Update {
+        Kind kind;
+        VertexId u;
+        VertexId v;
+    };
+
+private:
+    std::vector<Update> updates;
+
+public:
+    void add(VertexId u, VertexId v) {
+        updates.push_back({Kind::Add, u, v});
+    }
+
+    void remove(VertexId u, VertexId v) {
+        updates.push_back({Kind::Remove, u, v});
+    }
+
+    bool empty() const {
+        return updates.empty();
+    }
+
+    size_t size() const {
+        return updates.size();
+    }
+
+    const std::vector<Update>& getUpdates() const {
+        return updates;
+    }
+};
+
+/**
+ * @brief Immutable version of a VersionedGraph, keeps the version alive while it is held.
+ *
+ * Any number of threads can run algorithms on the same snapshot. Do not convertTo() a snapshot: the conversion
+ * mutates the shared graph, convert through VersionedGraph::convert() instead.
+ */
+export template <typename GraphTypeImplementationGeneralizer>
+class GraphSnapshot {
+public:
+    struct Version {
+        GraphTypeImplementationGeneralizer graph;
+        std::uint64_t number;
+    };
+
+private:
+    std::shared_ptr<const Version> version;
+
+public:
+    GraphSnapshot() = default;
+    explicit GraphSnapshot(std::shared_ptr<const Version> v) : version(std::move(v)) {}
+
+    const GraphTypeImplementationGeneralizer& operator*() const {
+        return version->graph;
+    }
+
+    const GraphTypeImplementationGeneralizer* operator->() const {
+        return &version->graph;
+    }
+
+    std::uint64_t getVersion() const {
+        return version->number;
+    }
+
+    explicit operator bool() const {
+        return version != nullptr;
+    }
+};
+
+/**
+ * @brief Multi-version graph: readers work on immutable snapshots while a writer publishes new versions.
+ *
+ * RCU style: a writer copies the current version, applies its changes to the private copy and publishes it with one
+ * atomic pointer swap. Readers never see a half applied batch. A version is freed when the last snapshot of it is
+ * dropped. Writers are serialized. A batch or conversion while a snapshot holds the current version copies its active
+ * representation, O(V+E) no matter how few edges the batch touches, so updates should be batched. Representations
+ * stashed by earlier conversions are not copied. While no snapshot holds the current version, apply() and convert()
+ * change it in place instead, O(batch), and snapshot() waits for them.
+ */
+export template <typename GraphTypeImplementationGeneralizer = ImplementedGraph>
+class VersionedGraph {
+public:
+    using vertex_type = typename GraphTypeImplementationGeneralizer::vertex_type;
+    using snapshot_type = GraphSnapshot<GraphTypeImplementationGeneralizer>;
+    using batch_type = EdgeBatch<vertex_type>;
+
+private:
+    using Version = typename snapshot_type::Version;
+
+    // shared with the deleters, versions can outlive the VersionedGraph through their snapshots
+    std::shared_ptr<std::atomic<size_t>> live_versions = std::make_shared<std::atomic<size_t>>(0);
+    std::atomic<std::shared_ptr<const Version>> current;
+    std::mutex writer_mutex;
+    // held by snapshot() while it loads and by an in-place update, so no snapshot of a version being changed exists
+    mutable std::mutex in_place_mutex;
+
+    std::shared_ptr<const Version> make_version(GraphTypeImplementationGeneralizer graph, std::uint64_t number) {
+        live_versions->fetch_add(1, std::memory_order_relaxed);
+        return std::shared_ptr<const Version>(new Version{std::move(graph), number},
+            [counter = live_versions](const Version* version) {
+                delete version;
+                counter->fetch_sub(1, std::memory_order_relaxed);
+            });
+    }
+
+    // writer_mutex held
+    template <typename Mutation>
+    std::uint64_t publish_copy(Mutation& mutation) {
+        const std::shared_ptr<const Version> base = current.load(std::memory_order_acquire);
+        GraphTypeImplementationGeneralizer next{base->graph};
+        mutation(next);
+        const std::uint64_t number = base->number + 1;
+        current.store(make_version(std::move(next), number), std::memory_order_release);
+        return number;
+    }
+
+    // writer_mutex held. Mutation must not throw after it changed the graph, the version is not restored.
+    template <typename Mutation>
+    std::uint64_t update_in_place_or_copy(Mutation mutation) {
+        {
+            std::lock_guard lock(in_place_mutex);
+            const std::shared_ptr<const Version> base = current.load(std::memory_order_acquire);
+            // held by current and base only: no snapshot exists and none can be taken until the lock is released
+            if (base.use_count() == 2) {
+                // pairs with the release of the last dropped snapshot, its reads happen before our writes
+                std::atomic_thread_fence(std::memory_order_acquire);
+                // the version was created non-const by make_version
+                auto& version = const_cast<Version&>(*base);
+                mutation(version.graph);
+                return ++version.number;
+            }
+        }
+        return publish_copy(mutation);
+    }
+
+public:
+    explicit VersionedGraph(GraphTypeImplementationGeneralizer graph) : current(make_version(std::move(graph), 0)) {}
+
+    VersionedGraph(const VersionedGraph&) = delete;
+    VersionedGraph& operator=(const VersionedGraph&) = delete;
+
+    snapshot_type snapshot() const {
+        std::lock_guard lock(in_place_mutex);
+        return snapshot_type(current.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @brief Applies mutation to a copy of the current version and publishes the copy, returns the new version number.
+     * If mutation throws, nothing is published.
+     */
+    template <typename Mutation>
+    std::uint64_t update(Mutation mutation) {
+        std::lock_guard lock(writer_mutex);
+        return publish_copy(mutation);
+    }
+
+    /**
+     * @brief Applies the batch as one new version, in place if no snapshot holds the current version.
+     * A batch with an invalid vertex changes nothing.
+     */
+    std::uint64_t apply(const batch_type& batch) {
+        std::lock_guard lock(writer_mutex);
+        const vertex_type num_vertices = current.load(std::memory_order_acquire)->graph.numVertices();
+        for (const auto& [kind, u, v] : batch.getUpdates()) {
+            if (u < 0 || u >= num_vertices || v < 0 || v >= num_vertices) {
+                throw std::out_of_range("Invalid vertex index.");
+            }
+        }
+        return update_in_place_or_copy([&batch](GraphTypeImplementationGeneralizer& g) {
+            for (const auto& [kind, u, v] : batch.getUpdates()) {
+                if (kind == batch_type::Kind::Add) g.addEdge(u, v);
+                else g.removeEdge(u, v);
+            }
+        });
+    }
+
+    // convertTo() keeps the graph unchanged if the new representation cannot be built
+    template <typename GraphImplementationType>
+    std::uint64_t convert() {
+        std::lock_guard lock(writer_mutex);
+        return update_in_place_or_copy([](GraphTypeImplementationGeneralizer& g) {
+            g.template convertTo<GraphImplementationType>();
+        });
+    }
+
+    // published versions not yet freed: the current one plus the ones still held by snapshots
+    size_t retainedVersions() const {
+        return live_versions->load(std::memory_order_relaxed);
+    }
+};
@@ -16,15 +16,19 @@ export template <
 requires std::is_same_v<typename ConcreteAlgorithm::algorithm_interface, AlgorithmInterface>
 std::unique_ptr<AlgorithmInterface> make_decorated_algorithm() {
 
+    using GraphTypeImplementationGeneralizer = typename AlgorithmInterface::implementation_generalizer_type;
+    using Timing = TimingDecorator<GraphTypeImplementationGeneralizer, AlgorithmInterface>;
+    using VariantSelector = AutoImplementationChangerGraphStrategyExecutor<GraphTypeImplementationGeneralizer, AlgorithmInterface>;
+
     auto base_algo = std::make_unique<ConcreteAlgorithm>();
 
     if constexpr (TimeConversion) {
         // Time(VariantSelector(Algo))
-        auto variant_selector = std::make_unique<AutoImplementationChangerGraphStrategyExecutor<>>(std::move(base_algo));
-        return std::make_unique<TimingDecorator<>>(std::move(variant_selector));
+        auto variant_selector = std::make_unique<VariantSelector>(std::move(base_algo));
+        return std::make_unique<Timing>(std::move(variant_selector));
     } else {
         // VariantSelector(Time(Algo))
-        auto timer = std::make_unique<TimingDecorator<>>(std::move(base_algo));
-        return std::make_unique<AutoImplementationChangerGraphStrategyExecutor<>>(std::move(timer));
+        auto timer = std::make_unique<Timing>(std::move(base_algo));
+        return std::make_unique<VariantSelector>(std::move(timer));
     }
 }
\ No newline at end of file
@@ -1,20 +1,101 @@
 module;
 
 # include <memory>
+# include <variant>
+# include <cstdint>
+# include <limits>
+# include <stdexcept>
+# include <vector>
+# include <utility>
+# include <memory_resource>
 
 export module GraphFactory;
 
-class ImplementedGraph;
-class GraphNList;
+import GraphConcepts;
+import ImplementedGraph;
 
 export
 template <typename GraphTypeImplementationGeneralizer = ImplementedGraph>
 class GraphFactory {
 public:
-    template <typename GraphImplementationType = GraphNList>
-    static std::unique_ptr<GraphTypeImplementationGeneralizer> createGraph(int num_vertices) {
-        return std::make_unique<GraphTypeImplementationGeneralizer>(GraphImplementationType(num_vertices));
+    using vertex_type = typename GraphTypeImplementationGeneralizer::vertex_type;
+
+    template <typename GraphImplementationType = std::variant_alternative_t<0, typename GraphTypeImplementationGeneralizer::graph_variant>>
+    static std::unique_ptr<GraphTypeImplementationGeneralizer> createGraph(vertex_type num_vertices,
+                                                                           std::pmr::memory_resource* resource = std::pmr::get_default_resource()) {
+        // the graph storage is allocated from resource, which has to outlive the graph
+        return std::make_unique<GraphTypeImplementationGeneralizer>(GraphImplementationType(num_vertices, resource));
     }
 
     using implementation_generalizer_type = GraphTypeImplementationGeneralizer;
-};
\ No newline at end of file
+};
+
+export using AnyImplementedGraph = std::variant<
+    std::unique_ptr<ImplementedGraph16>,
+    std::unique_ptr<ImplementedGraph32>,
+    std::unique_ptr<ImplementedGraph32E64>
+>;
+
+/**
+ * @brief Creates the graph with the narrowest index types that can hold the given vertex and edge count.
+ * The algorithms count and index vertices with int, so at most INT_MAX vertices are accepted, and with 64 bit
+ * offsets ImplementedGraph32E64 holds any such graph: there is no 64 bit vertex alternative.
+ */
+export class NarrowestGraphFactory {
+    template <typename GraphTypeImplementationGeneralizer>
+    static constexpr bool fits(std::uint64_t num_vertices, std::uint64_t num_edges) {
+        return index_types_fit<typename GraphTypeImplementationGeneralizer::vertex_type,
+                               typename GraphTypeImplementationGeneralizer::edge_offset_type>(num_vertices, num_edges);
+    }
+
+public:
+    static AnyImplementedGraph createGraph(std::uint64_t num_vertices, std::uint64_t num_edges) {
+        if (num_vertices > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+            throw std::length_error("The algorithms support at most INT_MAX vertices.");
+        }
+        if (fits<ImplementedGraph16>(num_vertices, num_edges)) {
+            return GraphFactory<ImplementedGraph16>::createGraph(static_cast<std::uint16_t>(num_vertices));
+        }
+        if (fits<ImplementedGraph32>(num_vertices, num_edges)) {
+            return GraphFactory<ImplementedGraph32>::createGraph(static_cast<std::uint32_t>(num_vertices));
+        }
+        return GraphFactory<ImplementedGraph32E64>::createGraph(static_cast<std::uint32_t>(num_vertices));
+    }
+
+    /**
+     * @brief The graph to read edges into while their count is not known yet, narrowed by narrow() afterwards,
+     * so the edges are never buffered as pairs.
+     */
+    static std::unique_ptr<ImplementedGraph32E64> createWideGraph(std::uint64_t num_vertices) {
+        if (num_vertices > static_cast<std::uint64_t>(std::numeric_limits<int>::max())) {
+            throw std::length_error("The algorithms support at most INT_MAX vertices.");
+        }
+        return GraphFactory<ImplementedGraph32E64>::createGraph(static_cast<std::uint32_t>(num_vertices));
+    }
+
+    /**
+     * @brief Moves the graph to the narrowest index types for its vertex and edge count. A graph that needs
+     * 64 bit offsets is returned as is, a narrower one is copied once, keeping the order of every out-list.
+     */
+    static AnyImplementedGraph narrow(std::unique_ptr<ImplementedGraph32E64> graph) {
+        const std::uint64_t num_vertices = graph->numVertices();
+        const std::uint64_t num_edges = graph->numEdges();
+        auto copy = [&]<typename GraphTypeImplementationGeneralizer>() -> AnyImplementedGraph {
+            using vertex_type = typename GraphTypeImplementationGeneralizer::vertex_type;
+            auto narrow_graph = GraphFactory<GraphTypeImplementationGeneralizer>::createGraph(static_cast<vertex_type>(num_vertices));
+            for (std::uint32_t u = 0; u < num_vertices; ++u) {
+                for (std::uint32_t v : graph->outneighbors(u)) {
+                    narrow_graph->addEdge(static_cast<vertex_type>(u), static_cast<vertex_type>(v));
+                }
+            }
+            return narrow_graph;
+        };
+        if (fits<ImplementedGraph16>(num_vertices, num_edges)) {
+            return copy.template operator()<ImplementedGraph16>();
+        }
+        if (fits<ImplementedGraph32>(num_vertices, num_edges)) {
+            return copy.template operator()<ImplementedGraph32>();
+        }
+        return graph;
+    }
+};
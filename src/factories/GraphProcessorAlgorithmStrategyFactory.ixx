@@ -7,8 +7,7 @@ export module GraphProcessorAlgorithmStrategyFactory;
 import GraphAlgo;
 import IAlgorithm;
 import GraphConcepts;
-
-class ImplementedGraph;
+import ImplementedGraph;
 
 export
 template <
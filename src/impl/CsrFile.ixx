@@ -0,0 +1,486 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+export module CsrFile;
+
+import GraphConcepts;
+
+/**
+ * Disk resident CSR graph for the semi-external mode: the vertex arrays (offsets) are loaded into memory, the
+ * adjacency stays on disk and is streamed in large sequential blocks.
+ *
+ * Layout (native byte order): header, out offsets (V + 1 x uint64), out targets (E x uint32),
+ * in offsets (V + 1 x uint64), in targets (E x uint32). Both directions are stored, so backward traversals
+ * (strong connectivity, SCC) are sequential scans too.
+ */
+
+constexpr std::array<char, 8> csr_magic = {'M', 'G', 'M', 'C', 'C', 'C', 'S', 'R'};
+constexpr std::uint64_t csr_version = 1;
+
+struct CsrHeader {
+    std::array<char, 8> magic = csr_magic;
+    std::uint64_t version = csr_version;
+    std::uint64_t num_vertices = 0;
+    std::uint64_t num_edges = 0;
+};
+
+export enum class Direction { Out, In };
+
+export struct IoStats {
+    std::uint64_t bytes_read = 0;
+    std::uint64_t block_reads = 0;
+    std::uint64_t scans = 0;
+};
+
+export IoStats operator-(const IoStats& a, const IoStats& b) {
+    return IoStats{a.bytes_read - b.bytes_read, a.block_reads - b.block_reads, a.scans - b.scans};
+}
+
+export constexpr size_t default_csr_block_bytes = size_t{8} << 20;
+
+template <typename T>
+void write_array(std::ofstream& out, std::span<const T> values) {
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+}
+
+template <typename T>
+void read_array(std::ifstream& in, std::span<T> values) {
+    if (!in.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()))) {
+        throw std::runtime_error("Truncated CSR file.");
+    }
+}
+
+// upper bound on the bucket files of one direction, the writer keeps the buckets of both directions open
+constexpr size_t max_csr_buckets = 128;
+
+/**
+ * @brief Edges of one direction partitioned by vertex range: each range gets a bucket file of (from, to) records in
+ * edge source order, so its targets can be filled in from that bucket alone. The bucket files are removed with it.
+ */
+class CsrBuckets {
+    using Record = std::array<std::uint32_t, 2>;
+
+    std::vector<std::uint64_t> range_first; // first vertex of every range, then num_vertices
+    std::vector<std::string> paths;
+    std::vector<std::ofstream> files;
+
+public:
+    // ranges of at least one vertex whose targets fit into capacity entries, or a single longer list
+    CsrBuckets(const std::string& prefix, const std::vector<std::uint64_t>& offsets, std::uint64_t capacity) {
+        const std::uint64_t num_vertices = offsets.size() - 1;
+        std::uint64_t first = 0;
+        while (first < num_vertices) {
+            range_first.push_back(first);
+            std::uint64_t last = first + 1;
+            while (last < num_vertices && offsets[last + 1] - offsets[first] <= capacity) ++last;
+            first = last;
+        }
+        range_first.push_back(num_vertices);
+        for (size_t r = 0; r + 1 < range_first.size(); ++r) {
+            paths.push_back(prefix + std::to_string(r));
+            files.emplace_back(paths.back(), std::ios::binary | std::ios::trunc);
+            if (!files.back().is_open()) throw std::runtime_error("Failed to open CSR bucket file: " + paths.back());
+        }
+    }
+
+    CsrBuckets(const CsrBuckets&) = delete;
+    CsrBuckets& operator=(const CsrBuckets&) = delete;
+
+    ~CsrBuckets() {
+        files.clear();
+        for (const auto& path : paths) {
+            std::error_code ignored;
+            std::filesystem::remove(path, ignored);
+        }
+    }
+
+    void add(std::uint64_t from, std::uint64_t to) {
+        const size_t r = std::upper_bound(range_first.begin(), range_first.end(), from) - range_first.begin() - 1;
+        const Record record = {static_cast<std::uint32_t>(from), static_cast<std::uint32_t>(to)};
+        files[r].write(reinterpret_cast<const char*>(record.data()), sizeof(record));
+    }
+
+    /**
+     * @brief Appends the targets of every range to out, in vertex order. Memory stays at one range plus a read buffer.
+     */
+    void write_targets(std::ofstream& out, const std::vector<std::uint64_t>& offsets) {
+        for (auto& file : files) {
+            file.close();
+            if (!file) throw std::runtime_error("Failed to write CSR bucket file.");
+        }
+        std::vector<std::uint32_t> buffer;
+        std::vector<std::uint64_t> cursor;
+        std::vector<Record> records((size_t{1} << 20) / sizeof(Record));
+        for (size_t r = 0; r < paths.size(); ++r) {
+            const std::uint64_t first = range_first[r];
+            const std::uint64_t last = range_first[r + 1];
+            const std::uint64_t base = offsets[first];
+            buffer.assign(offsets[last] - base, 0);
+            cursor.assign(offsets.begin() + first, offsets.begin() + last);
+            std::ifstream bucket(paths[r], std::ios::binary);
+            while (bucket) {
+                bucket.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(Record)));
+                const size_t count = static_cast<size_t>(bucket.gcount()) / sizeof(Record);
+                for (size_t i = 0; i < count; ++i) {
+                    buffer[cursor[records[i][0] - first]++ - base] = records[i][1];
+                }
+            }
+            write_array<std::uint32_t>(out, buffer);
+            bucket.close();
+            std::error_code ignored;
+            std::filesystem::remove(paths[r], ignored);
+        }
+    }
+};
+
+/**
+ * @brief Writes a CSR file from an edge source in two passes over it. edges(callback) calls callback(u, v) for every
+ * edge and has to give the same edges on every call. The first pass counts the degrees, the second partitions the
+ * edges of both directions into bucket files next to path by vertex range, every range is then filled in from its
+ * bucket. Memory stays at the vertex arrays plus one range of block_bytes, or of 2 * E / max_csr_buckets entries if
+ * that is larger, for any number of edges.
+ */
+export template <typename EdgeSource>
+void write_csr_file(const std::string& path, std::uint64_t num_vertices, EdgeSource edges,
+                    size_t block_bytes = default_csr_block_bytes) {
+    if (num_vertices > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("CSR files store vertex ids in 32 bits.");
+    }
+    std::vector<std::uint64_t> out_offsets(num_vertices + 1, 0);
+    std::vector<std::uint64_t> in_offsets(num_vertices + 1, 0);
+    edges([&](std::uint64_t u, std::uint64_t v) {
+        if (u >= num_vertices || v >= num_vertices) throw std::out_of_range("Invalid vertex index.");
+        ++out_offsets[u + 1];
+        ++in_offsets[v + 1];
+    });
+    for (std::uint64_t u = 0; u < num_vertices; ++u) {
+        out_offsets[u + 1] += out_offsets[u];
+        in_offsets[u + 1] += in_offsets[u];
+    }
+    const std::uint64_t num_edges = out_offsets.back();
+
+    // greedy ranges of up to capacity entries, at most 2 * E / capacity + 1 of them
+    const std::uint64_t capacity = std::max<std::uint64_t>({block_bytes / sizeof(std::uint32_t),
+                                                            2 * num_edges / max_csr_buckets, 1});
+    CsrBuckets out_buckets(path + ".out.", out_offsets, capacity);
+    CsrBuckets in_buckets(path + ".in.", in_offsets, capacity);
+    edges([&](std::uint64_t u, std::uint64_t v) {
+        out_buckets.add(u, v);
+        in_buckets.add(v, u);
+    });
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) throw std::runtime_error("Failed to open CSR file for writing: " + path);
+    const CsrHeader header{csr_magic, csr_version, num_vertices, num_edges};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_array<std::uint64_t>(out, out_offsets);
+    out_buckets.write_targets(out, out_offsets);
+    write_array<std::uint64_t>(out, in_offsets);
+    in_buckets.write_targets(out, in_offsets);
+    if (!out) throw std::runtime_error("Failed to write CSR file: " + path);
+}
+
+/**
+ * @brief Writes an in-memory graph as a CSR file.
+ */
+export template <IsGraph G>
+void write_csr_file(const std::string& path, const G& graph, size_t block_bytes = default_csr_block_bytes) {
+    write_csr_file(path, static_cast<std::uint64_t>(graph.numVertices()), [&graph](auto&& callback) {
+        for (typename G::vertex_type u = 0; u < graph.numVertices(); ++u) {
+            for (auto v : graph.outneighbors(u)) {
+                callback(static_cast<std::uint64_t>(u), static_cast<std::uint64_t>(v));
+            }
+        }
+    }, block_bytes);
+}
+
+/**
+ * @brief Converts a graph in the text format of the normal mode (vertex count, then "u v" pairs) to a CSR file.
+ * The text is parsed twice, once per pass of write_csr_file(), instead of being held in memory.
+ */
+export void convert_text_to_csr(const std::string& text_path, const std::string& csr_path,
+                                size_t block_bytes = default_csr_block_bytes) {
+    auto open = [&text_path](long long& n) {
+        std::ifstream in(text_path);
+        if (!in.is_open()) throw std::runtime_error("Failed to open graph file: " + text_path);
+        if (!(in >> n) || n < 0) throw std::invalid_argument("Invalid vertex count.");
+        return in;
+    };
+    long long n;
+    open(n);
+    write_csr_file(csr_path, static_cast<std::uint64_t>(n), [&](auto&& callback) {
+        long long count;
+        std::ifstream in = open(count);
+        long long u, v;
+        while (in >> u >> v) {
+            if (u < 0 || u >= count || v < 0 || v >= count) throw std::out_of_range("Invalid vertex index.");
+            callback(static_cast<std::uint64_t>(u), static_cast<std::uint64_t>(v));
+        }
+    }, block_bytes);
+}
+
+/**
+ * @brief Whether the file starts with the CSR header.
+ */
+export bool is_csr_file(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::array<char, 8> magic{};
+    return in.read(magic.data(), magic.size()) && magic == csr_magic;
+}
+
+/**
+ * @brief Read side of a CSR file. The offsets of both directions are kept in memory, the targets are only read by
+ * scan(): the adjacency of the selected vertices in increasing vertex order, in blocks of up to block_bytes.
+ * The next block is read by the file's reader thread while the current one is processed. Not thread-safe.
+ */
+export class CsrFile {
+public:
+    using vertex_type = std::uint32_t;
+    using offset_type = std::uint64_t;
+
+    explicit CsrFile(const std::string& path, size_t block_bytes = default_csr_block_bytes)
+        : block_bytes(std::max(block_bytes, sizeof(vertex_type))), file(path, std::ios::binary) {
+        if (!file.is_open()) throw std::runtime_error("Failed to open CSR file: " + path);
+        CsrHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != csr_magic) {
+            throw std::runtime_error("Not a CSR file: " + path);
+        }
+        if (header.version != csr_version) throw std::runtime_error("Unsupported CSR file version.");
+        if (header.num_vertices > std::numeric_limits<vertex_type>::max()) {
+            throw std::runtime_error("Corrupt CSR file header.");
+        }
+        V = header.num_vertices;
+        E = header.num_edges;
+
+        // the header has to describe exactly this file before anything is allocated for it
+        const offset_type offsets_bytes = (V + 1) * sizeof(offset_type);
+        const offset_type max_offset = std::numeric_limits<offset_type>::max();
+        if (E > (max_offset - sizeof(CsrHeader) - 2 * offsets_bytes) / (2 * sizeof(vertex_type))) {
+            throw std::runtime_error("Corrupt CSR file header.");
+        }
+        const offset_type targets_bytes = E * sizeof(vertex_type);
+        if (std::filesystem::file_size(path) != sizeof(CsrHeader) + 2 * (offsets_bytes + targets_bytes)) {
+            throw std::runtime_error("CSR file size does not match its header: " + path);
+        }
+
+        out_offsets.resize(V + 1);
+        read_array<offset_type>(file, out_offsets);
+        out_targets_position = sizeof(CsrHeader) + offsets_bytes;
+        const offset_type in_offsets_position = out_targets_position + targets_bytes;
+        file.seekg(static_cast<std::streamoff>(in_offsets_position));
+        in_offsets.resize(V + 1);
+        read_array<offset_type>(file, in_offsets);
+        in_targets_position = in_offsets_position + offsets_bytes;
+        // scan() and degree() index the targets with these without further checks
+        if (!valid_offsets(out_offsets) || !valid_offsets(in_offsets)) throw std::runtime_error("Corrupt CSR file offsets.");
+        reader = std::thread([this] { read_loop(); });
+    }
+
+    ~CsrFile() {
+        {
+            std::lock_guard lock(reader_mutex);
+            stopping = true;
+        }
+        reader_cv.notify_all();
+        reader.join();
+    }
+
+    CsrFile(const CsrFile&) = delete;
+    CsrFile& operator=(const CsrFile&) = delete;
+
+    vertex_type numVertices() const { return static_cast<vertex_type>(V); }
+    offset_type numEdges() const { return E; }
+
+    offset_type degree(Direction direction, vertex_type u) const {
+        const auto& offsets = offsets_of(direction);
+        return offsets[u + 1] - offsets[u];
+    }
+
+    // in memory, offsets[u + 1] - offsets[u] is the degree of u
+    std::span<const offset_type> offsets(Direction direction) const {
+        return offsets_of(direction);
+    }
+
+    IoStats io_stats() const { return io; }
+
+    /**
+     * @brief Calls body(u, neighbors) for every vertex u with selected(u), in increasing order. The selection is taken
+     * before the first block is read, body may change what selected() would return.
+     */
+    template <typename Selected, typename Body>
+    void scan(Direction direction, Selected selected, Body body) {
+        const auto& offsets = offsets_of(direction);
+        std::vector<vertex_type> chosen;
+        for (offset_type u = 0; u < V; ++u) {
+            if (offsets[u + 1] != offsets[u] && selected(static_cast<vertex_type>(u))) chosen.push_back(static_cast<vertex_type>(u));
+        }
+        scan_vertices(direction, chosen, body);
+    }
+
+    /**
+     * @brief Calls body(u, neighbors) for the given vertices, which have to be increasing. Costs O(vertices.size())
+     * besides the reads, not O(V). Gaps between the vertices are read through instead of skipped if they are shorter
+     * than a sixteenth of a block.
+     */
+    template <typename Body>
+    void scan_vertices(Direction direction, std::span<const vertex_type> vertices, Body body) {
+        const auto& offsets = offsets_of(direction);
+        const offset_type max_gap = block_bytes / 16 / sizeof(vertex_type);
+        const offset_type capacity = block_bytes / sizeof(vertex_type);
+
+        // blocks of consecutive entries of chosen
+        std::vector<vertex_type> chosen;
+        std::vector<std::pair<size_t, size_t>> blocks;
+        for (const vertex_type u : vertices) {
+            if (offsets[u + 1] == offsets[u]) continue;
+            if (!blocks.empty()) {
+                const vertex_type block_first = chosen[blocks.back().first];
+                const vertex_type previous = chosen.back();
+                if (offsets[u] - offsets[previous + 1] <= max_gap && offsets[u + 1] - offsets[block_first] <= capacity) {
+                    chosen.push_back(u);
+                    ++blocks.back().second;
+                    continue;
+                }
+            }
+            blocks.emplace_back(chosen.size(), chosen.size() + 1);
+            chosen.push_back(u);
+        }
+        ++io.scans;
+        if (blocks.empty()) return;
+
+        const offset_type targets_position = direction == Direction::Out ? out_targets_position : in_targets_position;
+        auto request = [&](const std::pair<size_t, size_t>& block, std::vector<vertex_type>& buffer) {
+            const offset_type begin = offsets[chosen[block.first]];
+            const offset_type end = offsets[chosen[block.second - 1] + 1];
+            return ReadRequest{targets_position + begin * sizeof(vertex_type), end - begin, &buffer};
+        };
+
+        std::array<std::vector<vertex_type>, 2> buffers;
+        read(request(blocks[0], buffers[0]));
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            // read-ahead: only the reader thread touches the file until finish_read()
+            const bool read_ahead = b + 1 < blocks.size();
+            if (read_ahead) start_read(request(blocks[b + 1], buffers[(b + 1) % 2]));
+            const auto& buffer = buffers[b % 2];
+            const offset_type base = offsets[chosen[blocks[b].first]];
+            io.bytes_read += buffer.size() * sizeof(vertex_type);
+            ++io.block_reads;
+            try {
+                for (size_t i = blocks[b].first; i < blocks[b].second; ++i) {
+                    const vertex_type u = chosen[i];
+                    body(u, std::span<const vertex_type>(buffer.data() + (offsets[u] - base), offsets[u + 1] - offsets[u]));
+                }
+            } catch (...) {
+                // the body's exception wins over one of the read-ahead
+                if (read_ahead) {
+                    wait_read();
+                    read_error = nullptr;
+                }
+                throw;
+            }
+            if (read_ahead) finish_read();
+        }
+    }
+
+    template <typename Body>
+    void scan(Direction direction, Body body) {
+        scan(direction, [](vertex_type) { return true; }, body);
+    }
+
+private:
+    size_t block_bytes;
+    std::ifstream file;
+    offset_type V = 0;
+    offset_type E = 0;
+    std::vector<offset_type> out_offsets;
+    std::vector<offset_type> in_offsets;
+    offset_type out_targets_position = 0;
+    offset_type in_targets_position = 0;
+    IoStats io;
+
+    struct ReadRequest {
+        offset_type position;
+        offset_type count;
+        std::vector<vertex_type>* buffer;
+    };
+
+    // one slot handoff to the reader thread, it holds at most one read at a time
+    std::mutex reader_mutex;
+    std::condition_variable reader_cv;
+    ReadRequest pending_read{};
+    bool read_pending = false;
+    bool stopping = false;
+    std::exception_ptr read_error;
+    std::thread reader; // last, started once the file is open and validated
+
+    void read(const ReadRequest& request) {
+        request.buffer->resize(request.count);
+        file.clear(); // a failed read does not end the file
+        file.seekg(static_cast<std::streamoff>(request.position));
+        read_array<vertex_type>(file, *request.buffer);
+    }
+
+    void start_read(const ReadRequest& request) {
+        {
+            std::lock_guard lock(reader_mutex);
+            pending_read = request;
+            read_pending = true;
+        }
+        reader_cv.notify_all();
+    }
+
+    void wait_read() {
+        std::unique_lock lock(reader_mutex);
+        reader_cv.wait(lock, [this] { return !read_pending; });
+    }
+
+    void finish_read() {
+        wait_read();
+        if (read_error) std::rethrow_exception(std::exchange(read_error, nullptr));
+    }
+
+    void read_loop() {
+        std::unique_lock lock(reader_mutex);
+        while (true) {
+            reader_cv.wait(lock, [this] { return read_pending || stopping; });
+            if (!read_pending) return;
+            const ReadRequest request = pending_read;
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                read(request);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            read_error = error;
+            read_pending = false;
+            reader_cv.notify_all();
+        }
+    }
+
+    // from 0 to E, non-decreasing
+    bool valid_offsets(const std::vector<offset_type>& offsets) const {
+        return offsets.front() == 0 && offsets.back() == E && std::ranges::is_sorted(offsets);
+    }
+
+    const std::vector<offset_type>& offsets_of(Direction direction) const {
+        return direction == Direction::Out ? out_offsets : in_offsets;
+    }
+};
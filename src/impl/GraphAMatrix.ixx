@@ -8,6 +8,7 @@ module;
 #include <generator>
 #include <mutex>
 #include <memory>
+#include <memory_resource>
 
 export module GraphAMatrix;
 
@@ -15,41 +16,44 @@ import IGraph;
 import GraphConcepts;
 import SpanView;
 
-export class GraphAMatrix : public IGraph {
+export template <VertexIndex VertexId = int, EdgeIndex EdgeOffset = int>
+class BasicGraphAMatrix : public BasicIGraph<VertexId, EdgeOffset> {
 private:
-    int V;
-    int E;
+    VertexId V;
+    EdgeOffset E;
     // A single flat vector for the adjacency matrix for better cache locality, stores u->v edge count
-    std::vector<int> adj;
-    std::vector<int> rev_adj; //transposed
-    std::vector<int> out_degree_counts;
-    std::vector<int> in_degree_counts;
-
-    mutable std::vector<std::vector<int>> out_neighbor_cache;
-    mutable std::vector<bool> out_cache_valid;
-    mutable std::vector<std::vector<int>> in_neighbor_cache;
-    mutable std::vector<bool> in_cache_valid;
+    std::pmr::vector<EdgeOffset> adj;
+    std::pmr::vector<EdgeOffset> rev_adj; //transposed
+    std::pmr::vector<EdgeOffset> out_degree_counts;
+    std::pmr::vector<EdgeOffset> in_degree_counts;
+
+    mutable std::pmr::vector<std::pmr::vector<VertexId>> out_neighbor_cache;
+    // char instead of bool: vector<bool> packs the flags of neighboring vertices into one word, which the
+    // per vertex mutexes do not protect
+    mutable std::pmr::vector<char> out_cache_valid;
+    mutable std::pmr::vector<std::pmr::vector<VertexId>> in_neighbor_cache;
+    mutable std::pmr::vector<char> in_cache_valid;
 
     // thread-safe cache access
     mutable std::vector<std::unique_ptr<std::mutex>> out_neighbor_mutexes;
     mutable std::vector<std::unique_ptr<std::mutex>> in_neighbor_mutexes;
 
 
-    [[nodiscard]] constexpr size_t get_index(int u, int v) const {
+    [[nodiscard]] constexpr size_t get_index(VertexId u, VertexId v) const {
         return static_cast<size_t>(u) * V + v;
     }
 
-    std::generator<const int> _generate_outneighbors(int u) const {
-        for (int i = 0; i < V; ++i) {
-            for (int j = 0; j < adj[get_index(u, i)]; ++j) {
+    std::generator<const VertexId> _generate_outneighbors(VertexId u) const {
+        for (VertexId i = 0; i < V; ++i) {
+            for (EdgeOffset j = 0; j < adj[get_index(u, i)]; ++j) {
                 co_yield i;
             }
         }
     }
 
-    std::generator<const int> _generate_inneighbors(int u) const {
-        for (int i = 0; i < V; ++i) {
-            for (int j = 0; j < rev_adj[get_index(u, i)]; ++j) {
+    std::generator<const VertexId> _generate_inneighbors(VertexId u) const {
+        for (VertexId i = 0; i < V; ++i) {
+            for (EdgeOffset j = 0; j < rev_adj[get_index(u, i)]; ++j) {
                 co_yield i;
             }
         }
@@ -61,7 +65,7 @@ private:
         out_neighbor_mutexes.reserve(V);
         in_neighbor_mutexes.reserve(V);
 
-        for (int i = 0; i < V; ++i) {
+        for (VertexId i = 0; i < V; ++i) {
             out_neighbor_mutexes.push_back(std::make_unique<std::mutex>());
             in_neighbor_mutexes.push_back(std::make_unique<std::mutex>());
         }
@@ -70,8 +74,14 @@ private:
 public:
     using is_cache_local = std::true_type;
     using is_easily_mutable = std::true_type;
-
-    explicit GraphAMatrix(int num_vertices) : IGraph(), V(num_vertices), E(0) {
+    using is_degree_adaptive = std::false_type;
+    using vertex_type = VertexId;
+    using edge_offset_type = EdgeOffset;
+
+    explicit BasicGraphAMatrix(VertexId num_vertices, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : BasicIGraph<VertexId, EdgeOffset>(), V(num_vertices), E(0),
+          adj(resource), rev_adj(resource), out_degree_counts(resource), in_degree_counts(resource),
+          out_neighbor_cache(resource), out_cache_valid(resource), in_neighbor_cache(resource), in_cache_valid(resource) {
         if (num_vertices < 0) {
             throw std::invalid_argument("The number of vertices cannot be negative.");
         }
@@ -91,7 +101,10 @@ public:
     }
 
     template <IsGraph G>
-    explicit GraphAMatrix(const G& source_graph) : V(source_graph.numVertices()), E(0) {
+    explicit BasicGraphAMatrix(const G& source_graph, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : V(source_graph.numVertices()), E(0),
+          adj(resource), rev_adj(resource), out_degree_counts(resource), in_degree_counts(resource),
+          out_neighbor_cache(resource), out_cache_valid(resource), in_neighbor_cache(resource), in_cache_valid(resource) {
         if (V < 0) {
             throw std::invalid_argument("The number of vertices cannot be negative.");
         }
@@ -109,8 +122,8 @@ public:
             initialize_mutexes();
         }
 
-        for (int u = 0; u < V; ++u) {
-            for (int v : source_graph.outneighbors(u)) {
+        for (VertexId u = 0; u < V; ++u) {
+            for (VertexId v : source_graph.outneighbors(u)) {
                 if (v >= 0 && v < V) {
                     adj[get_index(u, v)]++;
                     ++out_degree_counts[u];
@@ -122,23 +135,24 @@ public:
         }
     }
 
-    // copy ctor
-    GraphAMatrix(const GraphAMatrix& other)
+    // copy ctor, the neighbor caches are not copied: other may be filling them concurrently.
+    // The copy stays on the resource of other.
+    BasicGraphAMatrix(const BasicGraphAMatrix& other)
         : V(other.V), E(other.E),
-          adj(other.adj), rev_adj(other.rev_adj),
-          out_degree_counts(other.out_degree_counts),
-          in_degree_counts(other.in_degree_counts),
-          out_neighbor_cache(other.out_neighbor_cache),
-          out_cache_valid(other.out_cache_valid),
-          in_neighbor_cache(other.in_neighbor_cache),
-          in_cache_valid(other.in_cache_valid) {
+          adj(other.adj, other.get_memory_resource()), rev_adj(other.rev_adj, other.get_memory_resource()),
+          out_degree_counts(other.out_degree_counts, other.get_memory_resource()),
+          in_degree_counts(other.in_degree_counts, other.get_memory_resource()),
+          out_neighbor_cache(other.V, other.get_memory_resource()),
+          out_cache_valid(other.V, false, other.get_memory_resource()),
+          in_neighbor_cache(other.V, other.get_memory_resource()),
+          in_cache_valid(other.V, false, other.get_memory_resource()) {
         if (V > 0) {
             initialize_mutexes();
         }
     }
 
     // move ctor
-    GraphAMatrix(GraphAMatrix&& other) noexcept
+    BasicGraphAMatrix(BasicGraphAMatrix&& other) noexcept
         : V(other.V), E(other.E),
           adj(std::move(other.adj)), rev_adj(std::move(other.rev_adj)),
           out_degree_counts(std::move(other.out_degree_counts)),
@@ -154,7 +168,7 @@ public:
     }
 
     // copy assignment
-    GraphAMatrix& operator=(const GraphAMatrix& other) {
+    BasicGraphAMatrix& operator=(const BasicGraphAMatrix& other) {
         if (this != &other) {
             V = other.V;
             E = other.E;
@@ -162,10 +176,12 @@ public:
             rev_adj = other.rev_adj;
             out_degree_counts = other.out_degree_counts;
             in_degree_counts = other.in_degree_counts;
-            out_neighbor_cache = other.out_neighbor_cache;
-            out_cache_valid = other.out_cache_valid;
-            in_neighbor_cache = other.in_neighbor_cache;
-            in_cache_valid = other.in_cache_valid;
+            out_neighbor_cache.clear();
+            out_neighbor_cache.resize(V);
+            out_cache_valid.assign(V, false);
+            in_neighbor_cache.clear();
+            in_neighbor_cache.resize(V);
+            in_cache_valid.assign(V, false);
 
             if (V > 0) {
                 initialize_mutexes();
@@ -175,7 +191,7 @@ public:
     }
 
     // move assignment
-    GraphAMatrix& operator=(GraphAMatrix&& other) noexcept {
+    BasicGraphAMatrix& operator=(BasicGraphAMatrix&& other) noexcept {
         if (this != &other) {
             V = other.V;
             E = other.E;
@@ -196,15 +212,19 @@ public:
         return *this;
     }
 
-    int numVertices() const override {
+    std::pmr::memory_resource* get_memory_resource() const {
+        return adj.get_allocator().resource();
+    }
+
+    VertexId numVertices() const override {
         return V;
     }
 
-    int numEdges() const override {
+    EdgeOffset numEdges() const override {
         return E;
     }
 
-    void addEdge(int u, int v) override {
+    void addEdge(VertexId u, VertexId v) override {
         if (u < 0 || u >= V || v < 0 || v >= V) [[unlikely]] {
             throw std::out_of_range("Invalid vertex index.");
         }
@@ -218,7 +238,7 @@ public:
         in_cache_valid[v] = false;
     }
 
-    void removeEdge(int u, int v) override {
+    void removeEdge(VertexId u, VertexId v) override {
         if (u < 0 || u >= V || v < 0 || v >= V) [[unlikely]] {
             throw std::out_of_range("Invalid vertex index.");
         }
@@ -234,7 +254,7 @@ public:
         }
     }
 
-    std::span<const int> outneighbors(int u) const override {
+    std::span<const VertexId> outneighbors(VertexId u) const override {
         if (u < 0 || u >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
@@ -243,8 +263,8 @@ public:
         if (!out_cache_valid[u]) {
             out_neighbor_cache[u].clear();
             out_neighbor_cache[u].reserve(out_degree_counts[u]);
-            for (int v = 0; v < V; ++v) {
-                for (int count = 0; count < adj[get_index(u, v)]; ++count) {
+            for (VertexId v = 0; v < V; ++v) {
+                for (EdgeOffset count = 0; count < adj[get_index(u, v)]; ++count) {
                     out_neighbor_cache[u].push_back(v);
                 }
             }
@@ -253,7 +273,7 @@ public:
         return out_neighbor_cache[u];
     }
 
-    std::span<const int> inneighbors(int u) const override {
+    std::span<const VertexId> inneighbors(VertexId u) const override {
         if (u < 0 || u >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
@@ -262,8 +282,8 @@ public:
         if (!in_cache_valid[u]) {
             in_neighbor_cache[u].clear();
             in_neighbor_cache[u].reserve(in_degree_counts[u]);
-            for (int v = 0; v < V; ++v) {
-                for (int count = 0; count < rev_adj[get_index(u, v)]; ++count) {
+            for (VertexId v = 0; v < V; ++v) {
+                for (EdgeOffset count = 0; count < rev_adj[get_index(u, v)]; ++count) {
                     in_neighbor_cache[u].push_back(v);
                 }
             }
@@ -272,25 +292,40 @@ public:
         return in_neighbor_cache[u];
     }
 
-    std::span<const int> connectedto(int u) const {
+    std::span<const EdgeOffset> connectedto(VertexId u) const {
         if (u < 0 || u >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
-        return std::span<const int>(&adj[get_index(u, 0)], V);
+        return std::span<const EdgeOffset>(&adj[get_index(u, 0)], V);
     }
 
-    int out_degree(int u) const override {
+    EdgeOffset out_degree(VertexId u) const override {
         if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
         return out_degree_counts[u];
     }
 
-    int in_degree(int u) const override {
+    EdgeOffset in_degree(VertexId u) const override {
         if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
         return in_degree_counts[u];
     }
 
-    GraphAMatrix getTranspose() const {
-        GraphAMatrix g_t(V);
+    std::span<const EdgeOffset> out_degrees() const override {
+        return out_degree_counts;
+    }
+
+    std::span<const EdgeOffset> in_degrees() const override {
+        return in_degree_counts;
+    }
+
+    bool has_edge(VertexId u, VertexId v) const override {
+        if (u < 0 || u >= V || v < 0 || v >= V) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        return adj[get_index(u, v)] > 0;
+    }
+
+    BasicGraphAMatrix getTranspose() const {
+        BasicGraphAMatrix g_t(V, get_memory_resource());
         g_t.adj = this->rev_adj;
         g_t.rev_adj = this->adj;
         g_t.out_degree_counts = this->in_degree_counts;
@@ -298,4 +333,6 @@ public:
         g_t.E = this->E;
         return g_t;
     }
-};
\ No newline at end of file
+};
+
+export using GraphAMatrix = BasicGraphAMatrix<int, int>;
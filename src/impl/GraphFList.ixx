@@ -7,39 +7,62 @@ module;
 #include <span>
 #include <numeric>
 #include <ranges>
-#include <execution>
+#include <functional>
+#include <memory_resource>
 
 export module GraphFList;
 
 import IGraph;
 import GraphConcepts;
+import TaskScheduler;
 
-export class GraphFList : public IGraph {
+export template <VertexIndex VertexId = int, EdgeIndex EdgeOffset = int>
+class BasicGraphFList : public BasicIGraph<VertexId, EdgeOffset> {
 private:
-    int V;
+    VertexId V;
     // out-edges
-    std::vector<int> edge_targets;
-    std::vector<int> out_offsets;
+    std::pmr::vector<VertexId> edge_targets;
+    std::pmr::vector<EdgeOffset> out_offsets;
 
     // in-edges
-    std::vector<int> rev_edge_targets;
-    std::vector<int> in_offsets;
+    std::pmr::vector<VertexId> rev_edge_targets;
+    std::pmr::vector<EdgeOffset> in_offsets;
+
+    // differences of the offsets, stored so out_degrees() / in_degrees() are contiguous
+    std::pmr::vector<EdgeOffset> out_degree_counts;
+    std::pmr::vector<EdgeOffset> in_degree_counts;
+
+    static std::pmr::vector<EdgeOffset> degrees_from_offsets(const std::pmr::vector<EdgeOffset>& offsets) {
+        std::pmr::vector<EdgeOffset> degrees(offsets.size() - 1, offsets.get_allocator());
+        std::transform(offsets.begin() + 1, offsets.end(), offsets.begin(), degrees.begin(), std::minus<>());
+        return degrees;
+    }
 
 public:
     using is_cache_local = std::true_type;
+    using is_degree_adaptive = std::false_type;
     using is_easily_mutable = std::false_type;
-    explicit GraphFList(int num_vertices) : V(num_vertices) {
+    using vertex_type = VertexId;
+    using edge_offset_type = EdgeOffset;
+
+    explicit BasicGraphFList(VertexId num_vertices, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : V(num_vertices), edge_targets(resource), out_offsets(resource), rev_edge_targets(resource),
+          in_offsets(resource), out_degree_counts(resource), in_degree_counts(resource) {
         if (num_vertices < 0) {
             throw std::invalid_argument("The number of vertices cannot be negative.");
         }
-        out_offsets.resize(V + 1, 0);
-        in_offsets.resize(V + 1, 0);
+        out_offsets.resize(static_cast<size_t>(V) + 1, 0);
+        in_offsets.resize(static_cast<size_t>(V) + 1, 0);
+        out_degree_counts.resize(V, 0);
+        in_degree_counts.resize(V, 0);
     }
 
     template <IsGraph G>
-    explicit GraphFList(const G& source_graph) : V(source_graph.numVertices()) {
-        out_offsets.resize(V + 1);
-        in_offsets.resize(V + 1);
+    explicit BasicGraphFList(const G& source_graph, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : V(source_graph.numVertices()), edge_targets(resource), out_offsets(resource), rev_edge_targets(resource),
+          in_offsets(resource), out_degree_counts(resource), in_degree_counts(resource) {
+        out_offsets.resize(static_cast<size_t>(V) + 1);
+        in_offsets.resize(static_cast<size_t>(V) + 1);
 
         if (V == 0) {
             out_offsets[V] = 0;
@@ -47,14 +70,11 @@ public:
             return;
         }
 
-        auto vertex_indices = std::views::iota(0, V);
-        size_t total_edges = std::transform_reduce(
-            std::execution::par,
-            vertex_indices.begin(),
-            vertex_indices.end(),
+        size_t total_edges = parallel_transform_reduce(
+            VertexId{0}, V,
             static_cast<size_t>(0),
             std::plus<>(),          // Reduce
-            [&](int i) {            // Transform
+            [&](VertexId i) {       // Transform
                 return source_graph.outneighbors(i).size();
             }
         );
@@ -63,37 +83,52 @@ public:
         rev_edge_targets.reserve(total_edges);
 
         // Build forward
-        for (int i = 0; i < V; ++i) {
-            out_offsets[i] = edge_targets.size();
+        for (VertexId i = 0; i < V; ++i) {
+            out_offsets[i] = static_cast<EdgeOffset>(edge_targets.size());
             auto neighbors = source_graph.outneighbors(i);
             edge_targets.insert(edge_targets.end(), neighbors.begin(), neighbors.end());
         }
-        out_offsets[V] = edge_targets.size();
+        out_offsets[V] = static_cast<EdgeOffset>(edge_targets.size());
 
         // Build reverse
-        for (int i = 0; i < V; ++i) {
-            in_offsets[i] = rev_edge_targets.size();
+        for (VertexId i = 0; i < V; ++i) {
+            in_offsets[i] = static_cast<EdgeOffset>(rev_edge_targets.size());
             auto neighbors = source_graph.inneighbors(i);
             rev_edge_targets.insert(rev_edge_targets.end(), neighbors.begin(), neighbors.end());
         }
-        in_offsets[V] = rev_edge_targets.size();
+        in_offsets[V] = static_cast<EdgeOffset>(rev_edge_targets.size());
+
+        out_degree_counts = degrees_from_offsets(out_offsets);
+        in_degree_counts = degrees_from_offsets(in_offsets);
     }
 
 
-    GraphFList(const GraphFList &) = default;
-    GraphFList(GraphFList &&) = default;
-    GraphFList &operator=(const GraphFList &) = default;
-    GraphFList &operator=(GraphFList &&) = default;
+    // copies stay on the resource of other
+    BasicGraphFList(const BasicGraphFList& other)
+        : V(other.V),
+          edge_targets(other.edge_targets, other.get_memory_resource()),
+          out_offsets(other.out_offsets, other.get_memory_resource()),
+          rev_edge_targets(other.rev_edge_targets, other.get_memory_resource()),
+          in_offsets(other.in_offsets, other.get_memory_resource()),
+          out_degree_counts(other.out_degree_counts, other.get_memory_resource()),
+          in_degree_counts(other.in_degree_counts, other.get_memory_resource()) {}
+    BasicGraphFList(BasicGraphFList &&) = default;
+    BasicGraphFList &operator=(const BasicGraphFList &) = default;
+    BasicGraphFList &operator=(BasicGraphFList &&) = default;
+
+    std::pmr::memory_resource* get_memory_resource() const {
+        return edge_targets.get_allocator().resource();
+    }
 
-    auto numVertices() const -> int override {
+    auto numVertices() const -> VertexId override {
         return V;
     }
 
-    auto numEdges() const -> int override {
-        return edge_targets.size();
+    auto numEdges() const -> EdgeOffset override {
+        return static_cast<EdgeOffset>(edge_targets.size());
     }
 
-    auto addEdge(int u, int v) -> void override {
+    auto addEdge(VertexId u, VertexId v) -> void override {
         if (u < 0 || u >= V || v < 0 || v >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
@@ -101,21 +136,23 @@ public:
         // Insert 'v' at the end of u's neighbour list
         auto insert_pos_out = edge_targets.begin() + out_offsets[u+1];
         edge_targets.insert(insert_pos_out, v); //SLOW
+        ++out_degree_counts[u];
 
         // Update following offsets
-        for (int i = u + 1; i <= V; ++i) {
+        for (size_t i = static_cast<size_t>(u) + 1; i <= static_cast<size_t>(V); ++i) {
             out_offsets[i]++;
         }
 
         // reverse edge
         auto insert_pos_in = rev_edge_targets.begin() + in_offsets[v+1];
         rev_edge_targets.insert(insert_pos_in, u);
-        for (int i = v + 1; i <= V; ++i) {
+        ++in_degree_counts[v];
+        for (size_t i = static_cast<size_t>(v) + 1; i <= static_cast<size_t>(V); ++i) {
             in_offsets[i]++;
         }
     }
 
-    auto removeEdge(int u, int v) -> void override {
+    auto removeEdge(VertexId u, VertexId v) -> void override {
         if (u < 0 || u >= V || v < 0 || v >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
@@ -127,7 +164,8 @@ public:
 
         if (it_out != out_end_it) {
             edge_targets.erase(it_out);
-            for (int i = u + 1; i <= V; ++i) {
+            --out_degree_counts[u];
+            for (size_t i = static_cast<size_t>(u) + 1; i <= static_cast<size_t>(V); ++i) {
                 out_offsets[i]--;
             }
         }
@@ -139,13 +177,14 @@ public:
 
         if (it_in != in_end_it) {
             rev_edge_targets.erase(it_in);
-            for (int i = v + 1; i <= V; ++i) {
+            --in_degree_counts[v];
+            for (size_t i = static_cast<size_t>(v) + 1; i <= static_cast<size_t>(V); ++i) {
                 in_offsets[i]--;
             }
         }
     }
 
-    std::span<const int> outneighbors(int u) const override {
+    std::span<const VertexId> outneighbors(VertexId u) const override {
         if (u < 0 || u >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
@@ -155,7 +194,7 @@ public:
         return {&edge_targets[start_idx], static_cast<size_t>(count)};
     }
 
-    std::span<const int> inneighbors(int u) const override {
+    std::span<const VertexId> inneighbors(VertexId u) const override {
         if (u < 0 || u >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
@@ -165,22 +204,43 @@ public:
         return {&rev_edge_targets[start_idx], static_cast<size_t>(count)};
     }
 
-    auto out_degree(int u) const -> int override {
+    auto out_degree(VertexId u) const -> EdgeOffset override {
         if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
         return out_offsets[u+1] - out_offsets[u];
     }
 
-    auto in_degree(int u) const -> int override {
+    auto in_degree(VertexId u) const -> EdgeOffset override {
         if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
         return in_offsets[u+1] - in_offsets[u];
     }
 
-    GraphFList getTranspose() const {
-        GraphFList g_t(V);
+    std::span<const EdgeOffset> out_degrees() const override {
+        return out_degree_counts;
+    }
+
+    std::span<const EdgeOffset> in_degrees() const override {
+        return in_degree_counts;
+    }
+
+    // searches the shorter of the two lists
+    bool has_edge(VertexId u, VertexId v) const override {
+        if (u < 0 || u >= V || v < 0 || v >= V) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        if (out_degree(u) <= in_degree(v)) return std::ranges::find(outneighbors(u), v) != outneighbors(u).end();
+        return std::ranges::find(inneighbors(v), u) != inneighbors(v).end();
+    }
+
+    BasicGraphFList getTranspose() const {
+        BasicGraphFList g_t(V, get_memory_resource());
         g_t.edge_targets = this->rev_edge_targets;
         g_t.out_offsets = this->in_offsets;
         g_t.rev_edge_targets = this->edge_targets;
         g_t.in_offsets = this->out_offsets;
+        g_t.out_degree_counts = this->in_degree_counts;
+        g_t.in_degree_counts = this->out_degree_counts;
         return g_t;
     }
-};
\ No newline at end of file
+};
+
+export using GraphFList = BasicGraphFList<int, int>;
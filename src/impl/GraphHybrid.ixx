@@ -0,0 +1,424 @@
+module;
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+export module GraphHybrid;
+
+import IGraph;
+import GraphConcepts;
+import TaskScheduler;
+
+export enum class AdjacencyFormat {
+    Inline, // targets inside the row itself
+    Sorted, // sorted segment of the shared target array
+    Bitmap  // sorted segment plus a bitmap row for constant time membership tests
+};
+
+/**
+ * @brief Adjacency of one direction, every row stored in the format that suits its degree.
+ *
+ * A row is one cache line. Rows up to inline_capacity targets keep them inline, so visiting a low degree vertex
+ * touches a single line. Longer rows are sorted segments of one shared array (CSR like, with slack for insertions):
+ * a segment that outgrows its capacity moves to the end of the array with twice the capacity, and the array is
+ * compacted once half of it is garbage. Hubs, rows whose segment would not be smaller than a V bit bitmap,
+ * also get a bitmap row. The bitmap only answers membership, the segment keeps the multiplicity of parallel edges
+ * and serves the spans, so iteration is the same for every format.
+ */
+template <VertexIndex VertexId, EdgeIndex EdgeOffset>
+class HybridRows {
+public:
+    static constexpr size_t row_bytes = 64;
+    static constexpr size_t header_bytes = 4 * sizeof(EdgeOffset);
+    static constexpr size_t inline_capacity = (row_bytes - header_bytes) / sizeof(VertexId);
+    static_assert(inline_capacity >= 2, "A row has to fit at least two inline targets.");
+
+private:
+    struct alignas(row_bytes) Row {
+        EdgeOffset degree = 0;
+        EdgeOffset capacity = 0; // of the segment, 0 while the targets are inline
+        EdgeOffset offset = 0;   // start of the segment
+        EdgeOffset bitmap = 0;   // bitmap row + 1, 0 without a bitmap
+        VertexId inline_targets[inline_capacity] = {};
+    };
+
+    VertexId V = 0;
+    size_t words_per_bitmap = 0;
+    std::pmr::vector<Row> rows;
+    std::pmr::vector<EdgeOffset> degree_counts; // same as the row degrees, contiguous for degrees()
+    std::pmr::vector<VertexId> targets;
+    size_t garbage = 0; // targets no segment uses any more
+    std::pmr::vector<std::uint64_t> bitmap_words;
+    std::pmr::vector<EdgeOffset> free_bitmaps;
+
+    bool is_hub_degree(size_t degree) const {
+        return degree > inline_capacity && degree * sizeof(VertexId) * 8 >= static_cast<size_t>(V);
+    }
+
+    // demotion waits until the segment is half the size of the bitmap, so a row does not flip on every update
+    bool is_below_hub_degree(size_t degree) const {
+        return degree <= inline_capacity || 2 * degree * sizeof(VertexId) * 8 < static_cast<size_t>(V);
+    }
+
+    std::uint64_t* bitmap_of(const Row& row) {
+        return bitmap_words.data() + static_cast<size_t>(row.bitmap - 1) * words_per_bitmap;
+    }
+
+    const std::uint64_t* bitmap_of(const Row& row) const {
+        return bitmap_words.data() + static_cast<size_t>(row.bitmap - 1) * words_per_bitmap;
+    }
+
+    VertexId* data_of(Row& row) {
+        return row.capacity == 0 ? row.inline_targets : targets.data() + static_cast<size_t>(row.offset);
+    }
+
+    const VertexId* data_of(const Row& row) const {
+        return row.capacity == 0 ? row.inline_targets : targets.data() + static_cast<size_t>(row.offset);
+    }
+
+    void attach_bitmap(Row& row) {
+        if (free_bitmaps.empty()) {
+            bitmap_words.resize(bitmap_words.size() + words_per_bitmap, 0);
+            row.bitmap = static_cast<EdgeOffset>(bitmap_words.size() / words_per_bitmap);
+        } else {
+            row.bitmap = free_bitmaps.back();
+            free_bitmaps.pop_back();
+        }
+        std::uint64_t* words = bitmap_of(row);
+        for (VertexId v : std::span<const VertexId>(data_of(row), static_cast<size_t>(row.degree))) {
+            words[static_cast<size_t>(v) / 64] |= std::uint64_t{1} << (static_cast<size_t>(v) % 64);
+        }
+    }
+
+    void detach_bitmap(Row& row) {
+        std::fill_n(bitmap_of(row), words_per_bitmap, 0);
+        free_bitmaps.push_back(row.bitmap);
+        row.bitmap = 0;
+    }
+
+    // moves the row to a new segment at the end of the target array
+    void relocate(Row& row, size_t new_capacity) {
+        const size_t degree = static_cast<size_t>(row.degree);
+        const size_t new_offset = targets.size();
+        targets.resize(new_offset + new_capacity);
+        std::memcpy(targets.data() + new_offset, data_of(row), degree * sizeof(VertexId));
+        garbage += static_cast<size_t>(row.capacity);
+        row.offset = static_cast<EdgeOffset>(new_offset);
+        row.capacity = static_cast<EdgeOffset>(new_capacity);
+    }
+
+    void move_inline(Row& row) {
+        VertexId moved[inline_capacity];
+        std::memcpy(moved, data_of(row), static_cast<size_t>(row.degree) * sizeof(VertexId));
+        garbage += static_cast<size_t>(row.capacity);
+        row.capacity = 0;
+        row.offset = 0;
+        std::memcpy(row.inline_targets, moved, static_cast<size_t>(row.degree) * sizeof(VertexId));
+    }
+
+    void compact_if_needed() {
+        if (garbage < 1024 || 2 * garbage < targets.size()) return;
+        std::pmr::vector<VertexId> compacted(targets.get_allocator());
+        compacted.reserve(targets.size() - garbage);
+        for (Row& row : rows) {
+            if (row.capacity == 0) continue;
+            const size_t offset = compacted.size();
+            compacted.insert(compacted.end(), data_of(row), data_of(row) + static_cast<size_t>(row.degree));
+            row.offset = static_cast<EdgeOffset>(offset);
+            row.capacity = row.degree;
+        }
+        targets = std::move(compacted);
+        garbage = 0;
+    }
+
+public:
+    HybridRows(VertexId num_vertices, std::pmr::memory_resource* resource)
+        : V(num_vertices), words_per_bitmap((static_cast<size_t>(num_vertices) + 63) / 64),
+          rows(static_cast<size_t>(num_vertices), resource), degree_counts(static_cast<size_t>(num_vertices), 0, resource),
+          targets(resource), bitmap_words(resource), free_bitmaps(resource) {}
+
+    /**
+     * @brief Builds all rows at once from the neighbor lists of a graph, segments without slack.
+     */
+    template <typename Neighbors>
+    HybridRows(VertexId num_vertices, Neighbors neighbors_of, std::pmr::memory_resource* resource)
+        : HybridRows(num_vertices, resource) {
+        std::vector<size_t> offsets(static_cast<size_t>(V) + 1, 0);
+        for (VertexId u = 0; u < V; ++u) {
+            const size_t degree = neighbors_of(u).size();
+            degree_counts[u] = static_cast<EdgeOffset>(degree);
+            offsets[u + 1] = offsets[u] + (degree > inline_capacity ? degree : 0);
+        }
+        targets.resize(offsets[V]);
+        for (VertexId u = 0; u < V; ++u) {
+            Row& row = rows[u];
+            row.degree = degree_counts[u];
+            if (static_cast<size_t>(row.degree) > inline_capacity) {
+                row.offset = static_cast<EdgeOffset>(offsets[u]);
+                row.capacity = row.degree;
+            }
+        }
+        // rows are independent from here on
+        parallel_for(VertexId{0}, V, [&](VertexId u) {
+            Row& row = rows[u];
+            const auto neighbors = neighbors_of(u);
+            VertexId* data = data_of(row);
+            std::copy(neighbors.begin(), neighbors.end(), data);
+            std::sort(data, data + static_cast<size_t>(row.degree));
+        });
+        for (Row& row : rows) {
+            if (is_hub_degree(static_cast<size_t>(row.degree))) attach_bitmap(row);
+        }
+    }
+
+    // copies stay on the resource of other
+    HybridRows(const HybridRows& other)
+        : V(other.V), words_per_bitmap(other.words_per_bitmap),
+          rows(other.rows, other.get_memory_resource()),
+          degree_counts(other.degree_counts, other.get_memory_resource()),
+          targets(other.targets, other.get_memory_resource()), garbage(other.garbage),
+          bitmap_words(other.bitmap_words, other.get_memory_resource()),
+          free_bitmaps(other.free_bitmaps, other.get_memory_resource()) {}
+    HybridRows(HybridRows&&) = default;
+    HybridRows& operator=(const HybridRows&) = default;
+    HybridRows& operator=(HybridRows&&) = default;
+
+    std::pmr::memory_resource* get_memory_resource() const {
+        return rows.get_allocator().resource();
+    }
+
+    std::span<const VertexId> neighbors(VertexId u) const {
+        const Row& row = rows[u];
+        return {data_of(row), static_cast<size_t>(row.degree)};
+    }
+
+    std::span<const EdgeOffset> degrees() const {
+        return degree_counts;
+    }
+
+    bool contains(VertexId u, VertexId v) const {
+        const Row& row = rows[u];
+        if (row.bitmap != 0) {
+            return (bitmap_of(row)[static_cast<size_t>(v) / 64] >> (static_cast<size_t>(v) % 64)) & 1;
+        }
+        const VertexId* data = data_of(row);
+        const size_t degree = static_cast<size_t>(row.degree);
+        if (row.capacity == 0) {
+            // at most one cache line, a branch free scan vectorizes
+            unsigned found = 0;
+            for (size_t i = 0; i < degree; ++i) {
+                found |= static_cast<unsigned>(data[i] == v);
+            }
+            return found != 0;
+        }
+        return std::binary_search(data, data + degree, v);
+    }
+
+    AdjacencyFormat format(VertexId u) const {
+        const Row& row = rows[u];
+        if (row.bitmap != 0) return AdjacencyFormat::Bitmap;
+        return row.capacity == 0 ? AdjacencyFormat::Inline : AdjacencyFormat::Sorted;
+    }
+
+    void add(VertexId u, VertexId v) {
+        Row& row = rows[u];
+        const size_t degree = static_cast<size_t>(row.degree);
+        const size_t capacity = row.capacity == 0 ? inline_capacity : static_cast<size_t>(row.capacity);
+        if (degree == capacity) {
+            relocate(row, 2 * capacity);
+        }
+        VertexId* data = data_of(row);
+        VertexId* position = std::upper_bound(data, data + degree, v);
+        std::memmove(position + 1, position, static_cast<size_t>(data + degree - position) * sizeof(VertexId));
+        *position = v;
+        ++row.degree;
+        ++degree_counts[u];
+
+        if (row.bitmap != 0) {
+            bitmap_of(row)[static_cast<size_t>(v) / 64] |= std::uint64_t{1} << (static_cast<size_t>(v) % 64);
+        } else if (is_hub_degree(degree + 1)) {
+            attach_bitmap(row);
+        }
+        compact_if_needed();
+    }
+
+    // removes one copy of u -> v, returns false if there was none
+    bool remove(VertexId u, VertexId v) {
+        Row& row = rows[u];
+        VertexId* data = data_of(row);
+        const size_t degree = static_cast<size_t>(row.degree);
+        VertexId* position = std::lower_bound(data, data + degree, v);
+        if (position == data + degree || *position != v) return false;
+        std::memmove(position, position + 1, static_cast<size_t>(data + degree - position - 1) * sizeof(VertexId));
+        --row.degree;
+        --degree_counts[u];
+
+        if (row.bitmap != 0) {
+            if (is_below_hub_degree(degree - 1)) {
+                detach_bitmap(row);
+            } else if (position == data + degree - 1 || *position != v) {
+                // that was the last copy
+                bitmap_of(row)[static_cast<size_t>(v) / 64] &= ~(std::uint64_t{1} << (static_cast<size_t>(v) % 64));
+            }
+        }
+        if (row.capacity != 0 && static_cast<size_t>(row.degree) <= inline_capacity / 2) {
+            move_inline(row);
+        }
+        compact_if_needed();
+        return true;
+    }
+
+    // the transpose of a graph swaps its two directions, nothing has to be rebuilt; both have to be on one resource
+    friend void swap(HybridRows& a, HybridRows& b) noexcept {
+        using std::swap;
+        swap(a.V, b.V);
+        swap(a.words_per_bitmap, b.words_per_bitmap);
+        swap(a.rows, b.rows);
+        swap(a.degree_counts, b.degree_counts);
+        swap(a.targets, b.targets);
+        swap(a.garbage, b.garbage);
+        swap(a.bitmap_words, b.bitmap_words);
+        swap(a.free_bitmaps, b.free_bitmaps);
+    }
+};
+
+/**
+ * @brief Degree adaptive representation for skewed (power law) graphs, see HybridRows.
+ * Neighbors come in increasing order.
+ */
+export template <VertexIndex VertexId = int, EdgeIndex EdgeOffset = int>
+class BasicGraphHybrid : public BasicIGraph<VertexId, EdgeOffset> {
+private:
+    using Rows = HybridRows<VertexId, EdgeOffset>;
+
+    VertexId V;
+    EdgeOffset E;
+    Rows out_rows;
+    Rows in_rows;
+
+public:
+    using is_cache_local = std::true_type;
+    using is_easily_mutable = std::false_type;
+    using is_degree_adaptive = std::true_type;
+    using vertex_type = VertexId;
+    using edge_offset_type = EdgeOffset;
+
+    static constexpr size_t inline_capacity = Rows::inline_capacity;
+
+    explicit BasicGraphHybrid(VertexId num_vertices, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : BasicIGraph<VertexId, EdgeOffset>(), V(num_vertices), E(0),
+          out_rows(std::max(num_vertices, VertexId{0}), resource), in_rows(std::max(num_vertices, VertexId{0}), resource) {
+        if (num_vertices < 0) {
+            throw std::invalid_argument("The number of vertices cannot be negative.");
+        }
+    }
+
+    template <IsGraph G>
+    explicit BasicGraphHybrid(const G& source_graph, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : V(source_graph.numVertices()), E(source_graph.numEdges()),
+          out_rows(V, [&](VertexId u) { return source_graph.outneighbors(u); }, resource),
+          in_rows(V, [&](VertexId u) { return source_graph.inneighbors(u); }, resource) {}
+
+    BasicGraphHybrid(const BasicGraphHybrid &) = default;
+    BasicGraphHybrid(BasicGraphHybrid &&) = default;
+    BasicGraphHybrid &operator=(const BasicGraphHybrid &) = default;
+    BasicGraphHybrid &operator=(BasicGraphHybrid &&) = default;
+
+    std::pmr::memory_resource* get_memory_resource() const {
+        return out_rows.get_memory_resource();
+    }
+
+    VertexId numVertices() const override {
+        return V;
+    }
+
+    EdgeOffset numEdges() const override {
+        return E;
+    }
+
+    void addEdge(VertexId u, VertexId v) override {
+        if (u < 0 || u >= V || v < 0 || v >= V) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        out_rows.add(u, v);
+        in_rows.add(v, u);
+        E++;
+    }
+
+    void removeEdge(VertexId u, VertexId v) override {
+        if (u < 0 || u >= V || v < 0 || v >= V) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        if (out_rows.remove(u, v)) {
+            in_rows.remove(v, u);
+            E--;
+        }
+    }
+
+    std::span<const VertexId> outneighbors(VertexId u) const override {
+        if (u < 0 || u >= V) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        return out_rows.neighbors(u);
+    }
+
+    std::span<const VertexId> inneighbors(VertexId u) const override {
+        if (u < 0 || u >= V) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        return in_rows.neighbors(u);
+    }
+
+    EdgeOffset out_degree(VertexId u) const override {
+        if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
+        return out_rows.degrees()[u];
+    }
+
+    EdgeOffset in_degree(VertexId u) const override {
+        if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
+        return in_rows.degrees()[u];
+    }
+
+    std::span<const EdgeOffset> out_degrees() const override {
+        return out_rows.degrees();
+    }
+
+    std::span<const EdgeOffset> in_degrees() const override {
+        return in_rows.degrees();
+    }
+
+    // asks the side with a bitmap, or else the shorter one
+    bool has_edge(VertexId u, VertexId v) const override {
+        if (u < 0 || u >= V || v < 0 || v >= V) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        if (out_rows.format(u) == AdjacencyFormat::Bitmap) return out_rows.contains(u, v);
+        if (in_rows.format(v) == AdjacencyFormat::Bitmap) return in_rows.contains(v, u);
+        if (out_degree(u) <= in_degree(v)) return out_rows.contains(u, v);
+        return in_rows.contains(v, u);
+    }
+
+    AdjacencyFormat out_format(VertexId u) const {
+        if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
+        return out_rows.format(u);
+    }
+
+    AdjacencyFormat in_format(VertexId u) const {
+        if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
+        return in_rows.format(u);
+    }
+
+    BasicGraphHybrid getTranspose() const {
+        BasicGraphHybrid g_t(*this);
+        swap(g_t.out_rows, g_t.in_rows);
+        return g_t;
+    }
+};
+
+export using GraphHybrid = BasicGraphHybrid<int, int>;
@@ -4,126 +4,320 @@ module;
 #include <vector>
 #include <stdexcept>
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 #include <span>
 #include <type_traits>
+#include <memory_resource>
 
 export module GraphNList;
 
 import IGraph;
 import GraphConcepts;
 
-export class GraphNList : public IGraph {
+/**
+ * @brief Neighbor lists of one direction in two flat arrays instead of one heap allocation per vertex.
+ *
+ * Every vertex has a fixed size row. Lists up to inline_capacity targets live in the row itself, longer ones in a
+ * chunk of the shared slab. Chunks come in size classes, class k holds inline_capacity << k targets: a list that
+ * outgrows its chunk moves to a chunk of the next class and its old chunk goes to the free list of its class,
+ * linked through the free chunks themselves. Rows, slab and free list heads are trivially copyable, so a copy is
+ * three bulk copies. Growing the slab may move it, adding a target invalidates the spans of all chunked lists.
+ */
+template <VertexIndex VertexId, EdgeIndex EdgeOffset>
+class NeighborSlab {
+public:
+    static constexpr size_t row_bytes = 32;
+    static constexpr size_t header_bytes = (2 * sizeof(EdgeOffset) + 7) / 8 * 8;
+    static constexpr size_t inline_capacity = (row_bytes - header_bytes) / sizeof(VertexId);
+    static_assert(inline_capacity >= 2, "A row has to fit at least two inline targets.");
+
+private:
+    static constexpr size_t size_classes = 64;
+    static constexpr std::uint64_t no_chunk = std::numeric_limits<std::uint64_t>::max();
+
+    struct Row {
+        EdgeOffset degree = 0;
+        EdgeOffset size_class = 0; // 0 while the targets are inline
+        union {
+            VertexId inline_targets[inline_capacity] = {};
+            std::uint64_t chunk; // start of the chunk in the slab
+        };
+    };
+    static_assert(sizeof(Row) == row_bytes && std::is_trivially_copyable_v<Row>);
+
+    std::pmr::vector<Row> rows;
+    std::pmr::vector<VertexId> slab;
+    std::array<std::uint64_t, size_classes> free_chunks;
+
+    static size_t capacity_of(size_t size_class) {
+        return inline_capacity << size_class;
+    }
+
+    // the smallest class that holds degree targets
+    static size_t size_class_for(size_t degree) {
+        if (degree <= inline_capacity) return 0;
+        return static_cast<size_t>(std::bit_width((degree - 1) / inline_capacity));
+    }
+
+    VertexId* data_of(Row& row) {
+        return row.size_class == 0 ? row.inline_targets : slab.data() + row.chunk;
+    }
+
+    const VertexId* data_of(const Row& row) const {
+        return row.size_class == 0 ? row.inline_targets : slab.data() + row.chunk;
+    }
+
+    std::uint64_t allocate_chunk(size_t size_class) {
+        std::uint64_t chunk = free_chunks[size_class];
+        if (chunk != no_chunk) {
+            std::memcpy(&free_chunks[size_class], slab.data() + chunk, sizeof(std::uint64_t));
+            return chunk;
+        }
+        chunk = slab.size();
+        slab.resize(slab.size() + capacity_of(size_class));
+        return chunk;
+    }
+
+    // a chunk holds at least 2 * inline_capacity targets, at least 16 bytes, room for the link
+    void release_chunk(size_t size_class, std::uint64_t chunk) {
+        std::memcpy(slab.data() + chunk, &free_chunks[size_class], sizeof(std::uint64_t));
+        free_chunks[size_class] = chunk;
+    }
+
+    // moves the targets of the row into a chunk of the given class
+    void move_to_class(Row& row, size_t size_class) {
+        const std::uint64_t chunk = allocate_chunk(size_class);
+        std::memcpy(slab.data() + chunk, data_of(row), static_cast<size_t>(row.degree) * sizeof(VertexId));
+        if (row.size_class != 0) release_chunk(static_cast<size_t>(row.size_class), row.chunk);
+        row.chunk = chunk;
+        row.size_class = static_cast<EdgeOffset>(size_class);
+    }
+
+public:
+    NeighborSlab(VertexId num_vertices, std::pmr::memory_resource* resource)
+        : rows(static_cast<size_t>(num_vertices), resource), slab(resource) {
+        free_chunks.fill(no_chunk);
+    }
+
+    /**
+     * @brief Builds all lists at once, every list in the smallest class that holds it, the slab in one allocation.
+     */
+    template <typename Neighbors>
+    NeighborSlab(VertexId num_vertices, Neighbors neighbors_of, std::pmr::memory_resource* resource)
+        : NeighborSlab(num_vertices, resource) {
+        size_t slab_size = 0;
+        for (VertexId u = 0; u < num_vertices; ++u) {
+            const size_t size_class = size_class_for(neighbors_of(u).size());
+            if (size_class != 0) slab_size += capacity_of(size_class);
+        }
+        slab.reserve(slab_size);
+        for (VertexId u = 0; u < num_vertices; ++u) {
+            const auto neighbors = neighbors_of(u);
+            Row& row = rows[u];
+            if (const size_t size_class = size_class_for(neighbors.size()); size_class != 0) {
+                move_to_class(row, size_class);
+            }
+            row.degree = static_cast<EdgeOffset>(neighbors.size());
+            std::copy(neighbors.begin(), neighbors.end(), data_of(row));
+        }
+    }
+
+    // copies stay on the resource of other
+    NeighborSlab(const NeighborSlab& other)
+        : rows(other.rows, other.get_memory_resource()), slab(other.slab, other.get_memory_resource()),
+          free_chunks(other.free_chunks) {}
+    NeighborSlab(NeighborSlab&&) = default;
+    NeighborSlab& operator=(const NeighborSlab&) = default;
+    NeighborSlab& operator=(NeighborSlab&&) = default;
+
+    std::pmr::memory_resource* get_memory_resource() const {
+        return rows.get_allocator().resource();
+    }
+
+    std::span<const VertexId> neighbors(VertexId u) const {
+        const Row& row = rows[u];
+        return {data_of(row), static_cast<size_t>(row.degree)};
+    }
+
+    void push_back(VertexId u, VertexId v) {
+        Row& row = rows[u];
+        const size_t degree = static_cast<size_t>(row.degree);
+        if (degree == capacity_of(static_cast<size_t>(row.size_class))) {
+            move_to_class(row, size_class_for(degree + 1));
+        }
+        data_of(row)[degree] = v;
+        ++row.degree;
+    }
+
+    // removes the first occurrence of v, the list keeps its chunk
+    bool erase(VertexId u, VertexId v) {
+        Row& row = rows[u];
+        VertexId* data = data_of(row);
+        VertexId* end = data + static_cast<size_t>(row.degree);
+        VertexId* it = std::find(data, end, v);
+        if (it == end) return false;
+        std::copy(it + 1, end, it);
+        --row.degree;
+        return true;
+    }
+};
+
+export template <VertexIndex VertexId = int, EdgeIndex EdgeOffset = int>
+class BasicGraphNList : public BasicIGraph<VertexId, EdgeOffset> {
 private:
-    int V;
-    int E;
-    std::vector<std::vector<int>> adj;
-    std::vector<std::vector<int>> rev_adj;
+    VertexId V;
+    EdgeOffset E;
+    // both directions are slabs on the resource of the graph
+    NeighborSlab<VertexId, EdgeOffset> adj;
+    NeighborSlab<VertexId, EdgeOffset> rev_adj;
+    // kept next to the lists so out_degrees() / in_degrees() are contiguous
+    std::pmr::vector<EdgeOffset> out_degree_counts;
+    std::pmr::vector<EdgeOffset> in_degree_counts;
 public:
     using is_cache_local = std::false_type;
+    using is_degree_adaptive = std::false_type;
     using is_easily_mutable = std::true_type;
+    using vertex_type = VertexId;
+    using edge_offset_type = EdgeOffset;
 
-    explicit GraphNList(int num_vertices) : IGraph(), V(num_vertices), E(0) {
+    explicit BasicGraphNList(VertexId num_vertices, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : BasicIGraph<VertexId, EdgeOffset>(), V(num_vertices), E(0),
+          adj(std::max(num_vertices, VertexId{0}), resource), rev_adj(std::max(num_vertices, VertexId{0}), resource),
+          out_degree_counts(resource), in_degree_counts(resource) {
         if (num_vertices < 0) {
             throw std::invalid_argument("The number of verteces cannot be negative.");
         }
-        adj.resize(V);
-        rev_adj.resize(V);
+        out_degree_counts.resize(V, 0);
+        in_degree_counts.resize(V, 0);
     }
 
     template <IsGraph G>
-    explicit GraphNList(const G& source_graph) : V(source_graph.numVertices()), E(source_graph.numEdges()) {
+    explicit BasicGraphNList(const G& source_graph, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : V(source_graph.numVertices()), E(source_graph.numEdges()),
+          adj(std::max(V, VertexId{0}), [&source_graph](VertexId u) { return source_graph.outneighbors(u); }, resource),
+          rev_adj(std::max(V, VertexId{0}), [&source_graph](VertexId u) { return source_graph.inneighbors(u); }, resource),
+          out_degree_counts(resource), in_degree_counts(resource) {
         if (V < 0) {
             throw std::invalid_argument("The number of a vertex cannot be negative.");
         }
-        adj.resize(V);
-        rev_adj.resize(V);
-
-        for (int i = 0; i < V; ++i) {
-            auto out_neighbors = source_graph.outneighbors(i);
-            adj[i].assign(out_neighbors.begin(), out_neighbors.end());
-
-            auto in_neighbors = source_graph.inneighbors(i);
-            rev_adj[i].assign(in_neighbors.begin(), in_neighbors.end());
+        out_degree_counts.resize(V);
+        in_degree_counts.resize(V);
+        for (VertexId i = 0; i < V; ++i) {
+            out_degree_counts[i] = static_cast<EdgeOffset>(adj.neighbors(i).size());
+            in_degree_counts[i] = static_cast<EdgeOffset>(rev_adj.neighbors(i).size());
         }
     }
 
-    GraphNList(const GraphNList &) = default;
-    GraphNList(GraphNList &&) = default;
-    GraphNList &operator=(const GraphNList &) = default;
-    GraphNList &operator=(GraphNList &&) = default;
+    // copies stay on the resource of other (a plain pmr copy would fall back to the default resource)
+    BasicGraphNList(const BasicGraphNList& other)
+        : V(other.V), E(other.E),
+          adj(other.adj), rev_adj(other.rev_adj),
+          out_degree_counts(other.out_degree_counts, other.get_memory_resource()),
+          in_degree_counts(other.in_degree_counts, other.get_memory_resource()) {}
+    BasicGraphNList(BasicGraphNList &&) = default;
+    BasicGraphNList &operator=(const BasicGraphNList &) = default;
+    BasicGraphNList &operator=(BasicGraphNList &&) = default;
 
-    int numVertices() const override {
+    std::pmr::memory_resource* get_memory_resource() const {
+        return adj.get_memory_resource();
+    }
+
+    VertexId numVertices() const override {
         return V;
     }
 
-    int numEdges() const override {
+    EdgeOffset numEdges() const override {
         return E;
     }
 
-    void addEdge(int u, int v) override {
+    void addEdge(VertexId u, VertexId v) override {
         if (u < 0 || u >= V || v < 0 || v >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
-        adj[u].push_back(v);
-        rev_adj[v].push_back(u);
+        adj.push_back(u, v);
+        rev_adj.push_back(v, u);
+        ++out_degree_counts[u];
+        ++in_degree_counts[v];
         E++;
     }
 
-    void removeEdge(int u, int v) override {
+    void removeEdge(VertexId u, VertexId v) override {
         if (u < 0 || u >= V || v < 0 || v >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
-        auto& out_edges = adj[u];
-        if (auto it = std::ranges::find(out_edges, v); it != out_edges.end()) {
-            out_edges.erase(it);
+        if (adj.erase(u, v)) {
+            --out_degree_counts[u];
             E--;
-
-            auto& in_edges = rev_adj[v];
-            if (auto it_in = std::ranges::find(in_edges, u); it_in != in_edges.end()) {
-                in_edges.erase(it_in);
+            if (rev_adj.erase(v, u)) {
+                --in_degree_counts[v];
             }
         }
     }
 
-    std::span<const int> outneighbors(int u) const override {
+    std::span<const VertexId> outneighbors(VertexId u) const override {
         if (u < 0 || u >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
-        return adj[u];
+        return adj.neighbors(u);
     }
 
-    std::span<const int> inneighbors(int u) const override {
+    std::span<const VertexId> inneighbors(VertexId u) const override {
         if (u < 0 || u >= V) {
             throw std::out_of_range("Invalid vertex index.");
         }
-        return rev_adj[u];
+        return rev_adj.neighbors(u);
     }
 
-    int out_degree(int u) const override {
+    EdgeOffset out_degree(VertexId u) const override {
         if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
-        return adj[u].size();
+        return out_degree_counts[u];
     }
 
-    int in_degree(int u) const override {
+    EdgeOffset in_degree(VertexId u) const override {
         if (u < 0 || u >= V) { throw std::out_of_range("Invalid vertex index."); }
-        return rev_adj[u].size();
+        return in_degree_counts[u];
+    }
+
+    std::span<const EdgeOffset> out_degrees() const override {
+        return out_degree_counts;
+    }
+
+    std::span<const EdgeOffset> in_degrees() const override {
+        return in_degree_counts;
     }
 
-    // GraphNList getTranspose() const {
-    //     GraphNList g_t(V);
-    //     for (int u = 0; u < V; ++u) {
-    //         for (int v : this->adj[u]) {
+    // searches the shorter of the two lists
+    bool has_edge(VertexId u, VertexId v) const override {
+        if (u < 0 || u >= V || v < 0 || v >= V) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        if (out_degree(u) <= in_degree(v)) return std::ranges::find(outneighbors(u), v) != outneighbors(u).end();
+        return std::ranges::find(inneighbors(v), u) != inneighbors(v).end();
+    }
+
+    // BasicGraphNList getTranspose() const {
+    //     BasicGraphNList g_t(V);
+    //     for (VertexId u = 0; u < V; ++u) {
+    //         for (VertexId v : this->adj.neighbors(u)) {
     //             g_t.addEdge(v, u); //args order correct
     //         }
     //     }
     //     return g_t;
     // }
 
-    GraphNList getTranspose() const {
-        GraphNList g_t(V);
+    BasicGraphNList getTranspose() const {
+        BasicGraphNList g_t(V, get_memory_resource());
         g_t.adj = this->rev_adj;
         g_t.rev_adj = this->adj;
+        g_t.out_degree_counts = this->in_degree_counts;
+        g_t.in_degree_counts = this->out_degree_counts;
         g_t.E = this->E;
         return g_t;
     }
-};
\ No newline at end of file
+};
+
+export using GraphNList = BasicGraphNList<int, int>;
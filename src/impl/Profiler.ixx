@@ -14,12 +14,16 @@ module;
 #include <cmath>
 #include <sstream>
 #include <fstream>
+#include <filesystem>
+#include <memory_resource>
+#include <cstdint>
 
 export module Profiler;
 
 import GraphNList;
 import GraphFList;
 import GraphAMatrix;
+import GraphHybrid;
 import GraphAlgo;
 import ImplementedGraph;
 import AlgorithmResult;
@@ -28,7 +32,21 @@ import IAlgorithm;
 import AlgorithmDecorator;
 import DecoratorFactory;
 import Generator;
+import TaskScheduler;
+import Cancellation;
 import GraphProcessorAlgorithmStrategyFactory;
+import MemoryResources;
+import CsrFile;
+import SemiExternal;
+
+/**
+ * @brief Allocators of one profiling pass: the resource of the graph storage and the upstream of the scratch arenas.
+ */
+struct MemoryConfiguration {
+    std::string name;
+    std::pmr::memory_resource* graph_resource;
+    std::pmr::memory_resource* scratch_resource;
+};
 
 export void printProfilingResults(
     const std::map<std::string, std::map<std::string, std::optional<double>>>& results,
@@ -135,8 +153,52 @@ export void printProfilingResultsCSV(
     csv_file.close();
 }
 
+/**
+ * @brief Fallback for a size whose graph does not fit into memory: the edges go to a temporary CSR file and the
+ * semi-external algorithms run on it. Recorded as "SE-<problem>_on_CsrFile", with the I/O volume printed.
+ */
+void runSemiExternalFallback(int v_count, const std::vector<std::pair<int, int>>& edges, const std::string& size_key,
+                             std::map<std::string, std::map<std::string, std::optional<double>>>& results) {
+    const auto csr_path = std::filesystem::temp_directory_path() / ("mgmcc_profiling_" + std::to_string(v_count) + "_" +
+                                                                    std::to_string(edges.size()) + ".csr");
+    std::cout << "  Falling back to the semi-external mode on " << csr_path.string() << std::endl;
+    using Run = std::function<IoStats(CsrFile&, const CancellationToken&)>;
+    const std::vector<std::pair<std::string, Run>> runs = {
+        {"SE-sources", [](CsrFile& file, const CancellationToken&) { return semi_external_sources(file).io; }},
+        {"SE-strongly_connected", [](CsrFile& file, const CancellationToken& token) { return semi_external_is_strongly_connected(file, token).io; }},
+        {"SE-scc", [](CsrFile& file, const CancellationToken& token) { return semi_external_scc(file, token).io; }},
+        {"SE-bfs", [](CsrFile& file, const CancellationToken& token) { return semi_external_bfs(file, 0, Direction::Out, token).io; }},
+    };
+    try {
+        write_csr_file(csr_path.string(), static_cast<std::uint64_t>(v_count), [&edges](auto&& callback) {
+            for (const auto& [u, v] : edges) callback(static_cast<std::uint64_t>(u), static_cast<std::uint64_t>(v));
+        });
+        CsrFile file(csr_path.string());
+        for (const auto& [name, run] : runs) {
+            const std::string combined_name = name + "_on_CsrFile";
+            try {
+                const auto start = std::chrono::steady_clock::now();
+                const IoStats io = run(file, CancellationToken::after(std::chrono::seconds(5)));
+                const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                std::cout << "    - " << std::setw(20) << std::left << name << " finished in " << std::fixed
+                          << std::setprecision(6) << elapsed.count() << "s (io: " << io.bytes_read / 1024 << " KiB in "
+                          << io.block_reads << " reads)" << std::endl;
+                results[combined_name][size_key] = elapsed.count();
+            } catch (const std::exception& e) {
+                std::cout << "    - " << std::setw(20) << std::left << name << " failed: " << e.what() << std::endl;
+                results[combined_name][size_key] = std::nullopt;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cout << "    - Semi-external fallback failed: " << e.what() << std::endl;
+    }
+    std::error_code ignored;
+    std::filesystem::remove(csr_path, ignored);
+}
+
+// compare_memory_resources: run everything once per MemoryConfiguration (new/delete, pool, huge pages)
 export template <bool isDebugMode>
-void runProfilingMode(int profilinglevel = 3, bool use_csv = false) {
+void runProfilingMode(int profilinglevel = 3, bool use_csv = false, bool compare_memory_resources = false) {
     std::cout << "Starting profiling mode..." << std::endl;
     if constexpr (isDebugMode) {
         std::cout << "[INFO] Profiling a DEBUG build." << std::endl;
@@ -171,29 +233,51 @@ void runProfilingMode(int profilinglevel = 3, bool use_csv = false) {
     algorithms.push_back(factory.createPathBasedUniversalSourceFinderStrategy());
 
     using EdgeList = std::vector<std::pair<int, int>>;
-    std::map<std::string, std::function<std::unique_ptr<ImplementedGraph>(int, const EdgeList&)>> graph_factories;
+    using GraphBuilder = std::function<std::unique_ptr<ImplementedGraph>(int, const EdgeList&, std::pmr::memory_resource*)>;
+    std::map<std::string, GraphBuilder> graph_factories;
 
-    graph_factories["GraphNList"] = [](int v_count, const EdgeList& edges) {
-        auto g = GraphFactory<ImplementedGraph>::createGraph<GraphNList>(v_count);
+    graph_factories["GraphNList"] = [](int v_count, const EdgeList& edges, std::pmr::memory_resource* resource) {
+        auto g = GraphFactory<ImplementedGraph>::createGraph<GraphNList>(v_count, resource);
         for (const auto& edge : edges) {
             g->addEdge(edge.first, edge.second);
         }
         return g;
     };
-    graph_factories["GraphFList"] = [](int v_count, const EdgeList& edges) {
+    graph_factories["GraphFList"] = [](int v_count, const EdgeList& edges, std::pmr::memory_resource* resource) {
         GraphNList temp_g(v_count);
         for (const auto& edge : edges) {
             temp_g.addEdge(edge.first, edge.second);
         }
-        return std::make_unique<ImplementedGraph>(GraphFList(temp_g));
+        return std::make_unique<ImplementedGraph>(GraphFList(temp_g, resource));
     };
-     graph_factories["GraphAMatrix"] = [](int v_count, const EdgeList& edges) {
+     graph_factories["GraphAMatrix"] = [](int v_count, const EdgeList& edges, std::pmr::memory_resource* resource) {
         GraphNList temp_g(v_count);
         for (const auto& edge : edges) {
             temp_g.addEdge(edge.first, edge.second);
         }
-        return std::make_unique<ImplementedGraph>(GraphAMatrix(temp_g));
+        return std::make_unique<ImplementedGraph>(GraphAMatrix(temp_g, resource));
     };
+    graph_factories["GraphHybrid"] = [](int v_count, const EdgeList& edges, std::pmr::memory_resource* resource) {
+        GraphNList temp_g(v_count);
+        for (const auto& edge : edges) {
+            temp_g.addEdge(edge.first, edge.second);
+        }
+        return std::make_unique<ImplementedGraph>(GraphHybrid(temp_g, resource));
+    };
+
+    // the resources outlive every graph and arena of the run, the pool is shared by the scheduler's workers
+    HugePageResource huge_pages;
+    std::pmr::synchronized_pool_resource pool;
+    std::vector<MemoryConfiguration> memory_configurations = {
+        {"", std::pmr::new_delete_resource(), std::pmr::new_delete_resource()}
+    };
+    if (compare_memory_resources) {
+        memory_configurations = {
+            {"new_delete", std::pmr::new_delete_resource(), std::pmr::new_delete_resource()},
+            {"pool", &pool, &pool},
+            {"huge_pages", &huge_pages, &huge_pages},
+        };
+    }
 
 
     for (int v_count : steps) {
@@ -211,57 +295,88 @@ void runProfilingMode(int profilinglevel = 3, bool use_csv = false) {
             std::string size_key = "V:" + std::to_string(v_count) + ",E:" + std::to_string(e_count);
 
             auto edges = generate_erdos_renyi_edges(v_count, e_count);
+            // the semi-external mode is the fallback for sizes no in-memory representation could be built for
+            bool built_in_memory = false;
 
-            for (const auto& [graph_name, graph_builder] : graph_factories) {
-                std::cout << "  Testing on implementation: " << graph_name << std::endl;
+            for (const auto& memory : memory_configurations) {
+                // counts the scratch blocks of every run, on top of the configured upstream
+                CountingResource scratch_counter(memory.scratch_resource);
+                set_scratch_upstream(&scratch_counter);
+                const std::string memory_suffix = memory.name.empty() ? "" : "_with_" + memory.name;
+                if (!memory.name.empty()) std::cout << "  Memory resources: " << memory.name << std::endl;
 
-                std::unique_ptr<ImplementedGraph> g;
-                try {
-                     g = graph_builder(v_count, edges);
-                } catch (const std::bad_alloc& e) {
-                    std::cout << "    - Graph creation failed (Out of Memory). Skipping for this implementation." << std::endl;
-                    for (const auto& algo : algorithms) {
-                         std::string combined_name = std::string(algo->getName()) + "_on_" + graph_name;
-                         results[combined_name][size_key] = std::nullopt;
-                    }
-                    continue; // Skip to the next graph impl
-                }
-
-                for (const auto& algo : algorithms) {
-                    const std::string combined_name = std::string(algo->getName()) + "_on_" + graph_name;
+                for (const auto& [graph_name, graph_builder] : graph_factories) {
+                    std::cout << "  Testing on implementation: " << graph_name << std::endl;
 
-                    if (eliminated_algos.contains(combined_name)) {
-                        std::cout << "    - Skipping " << std::setw(20) << std::left << algo->getName() << " (eliminated)" << std::endl;
-                        results[combined_name][size_key] = std::nullopt;
-                        continue;
+                    std::unique_ptr<ImplementedGraph> g;
+                    try {
+                         g = graph_builder(v_count, edges, memory.graph_resource);
+                    } catch (const std::bad_alloc& e) {
+                        std::cout << "    - Graph creation failed (Out of Memory). Skipping for this implementation." << std::endl;
+                        for (const auto& algo : algorithms) {
+                             std::string combined_name = std::string(algo->getName()) + "_on_" + graph_name + memory_suffix;
+                             results[combined_name][size_key] = std::nullopt;
+                        }
+                        continue; // Skip to the next graph impl
                     }
+                    built_in_memory = true;
 
-                    try {
-                        const auto start = std::chrono::steady_clock::now();
-                        auto result = algo->execute(*g);
-                        const auto finish = std::chrono::steady_clock::now();
-                        const std::chrono::duration<double> elapsed = finish - start;
-                        double elapsed_sec = elapsed.count();
+                    for (const auto& algo : algorithms) {
+                        const std::string combined_name = std::string(algo->getName()) + "_on_" + graph_name + memory_suffix;
+
+                        if (eliminated_algos.contains(combined_name)) {
+                            std::cout << "    - Skipping " << std::setw(20) << std::left << algo->getName() << " (eliminated)" << std::endl;
+                            results[combined_name][size_key] = std::nullopt;
+                            continue;
+                        }
 
-                        std::cout << "    - " << std::setw(20) << std::left << algo->getName() << " finished in "
-                                  << std::fixed << std::setprecision(6) << elapsed_sec << "s" << std::endl;
+                        try {
+                            TaskScheduler::global().reset_stats();
+                            scratch_counter.reset_peak();
+                            const auto start = std::chrono::steady_clock::now();
+                            // runs are cut off at the time limit instead of being eliminated after finishing a long run
+                            auto result = algo->execute(*g, CancellationToken::after(std::chrono::seconds(5)));
+                            const auto finish = std::chrono::steady_clock::now();
+                            const std::chrono::duration<double> elapsed = finish - start;
+                            double elapsed_sec = elapsed.count();
 
-                        results[combined_name][size_key] = elapsed_sec;
+                            std::cout << "    - " << std::setw(20) << std::left << algo->getName() << " finished in "
+                                      << std::fixed << std::setprecision(6) << elapsed_sec << "s";
+                            // only parallel strategies put work on the scheduler
+                            if (const SchedulerStats scheduler_stats = TaskScheduler::global().stats(); scheduler_stats.tasks_executed > 0) {
+                                std::cout << " (scheduler: " << scheduler_stats.tasks_executed << " tasks, "
+                                          << scheduler_stats.tasks_stolen << " stolen, "
+                                          << std::setprecision(2) << scheduler_stats.utilization * 100 << "% utilization)";
+                            }
+                            std::cout << " (scratch: " << scratch_counter.peak_bytes() / 1024 << " KiB peak)" << std::endl;
 
-                        if (elapsed_sec > 5.0) {
+                            if (isPartial(result)) {
+                                std::cout << "      -> Hit the time limit, eliminating " << combined_name << " for future runs." << std::endl;
+                                results[combined_name][size_key] = std::nullopt;
+                                eliminated_algos.insert(combined_name);
+                            } else {
+                                results[combined_name][size_key] = elapsed_sec;
+                            }
+                        } catch (const OperationCancelled& e) {
+                            std::cout << "    - " << std::setw(20) << std::left << algo->getName() << " hit the time limit" << std::endl;
                             std::cout << "      -> Eliminating " << combined_name << " for future runs." << std::endl;
+                            results[combined_name][size_key] = std::nullopt;
+                            eliminated_algos.insert(combined_name);
+                        } catch (const std::bad_alloc& e) {
+                            std::cout << "    - " << std::setw(20) << std::left << algo->getName() << " failed with std::bad_alloc (Out of Memory)" << std::endl;
+                            results[combined_name][size_key] = std::nullopt;
+                            eliminated_algos.insert(combined_name);
+                        } catch (const std::exception& e) {
+                             std::cout << "    - " << std::setw(20) << std::left << algo->getName() << " failed with exception: " << e.what() << std::endl;
+                            results[combined_name][size_key] = std::nullopt;
                             eliminated_algos.insert(combined_name);
                         }
-                    } catch (const std::bad_alloc& e) {
-                        std::cout << "    - " << std::setw(20) << std::left << algo->getName() << " failed with std::bad_alloc (Out of Memory)" << std::endl;
-                        results[combined_name][size_key] = std::nullopt;
-                        eliminated_algos.insert(combined_name);
-                    } catch (const std::exception& e) {
-                         std::cout << "    - " << std::setw(20) << std::left << algo->getName() << " failed with exception: " << e.what() << std::endl;
-                        results[combined_name][size_key] = std::nullopt;
-                        eliminated_algos.insert(combined_name);
                     }
                 }
+                set_scratch_upstream(nullptr);
+            }
+            if (!built_in_memory) {
+                runSemiExternalFallback(v_count, edges, size_key, results);
             }
         }
         eliminated_algos.clear();
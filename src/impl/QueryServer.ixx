@@ -0,0 +1,282 @@
+module;
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <variant>
+#include <utility>
+#include <stdexcept>
+#include <optional>
+#include <cstdint>
+#include <chrono>
+
+export module QueryServer;
+
+import ImplementedGraph;
+import GraphFactory;
+import GraphAlgo;
+import IAlgorithm;
+import AlgorithmResult;
+import StrategyProvider;
+import Properties;
+import TaskScheduler;
+import Cancellation;
+import VersionedGraph;
+
+/**
+ * @brief Keeps one graph resident and answers line based queries against it.
+ *
+ * Every request line gets a sequence number (its line number, starting at 1) and exactly one response line
+ * "<seq> ok <payload>" or "<seq> error <message>". Read queries (solve, stats, scheduler) run concurrently on the
+ * task scheduler, so their responses may arrive out of order. Every query runs on the snapshot of the graph taken
+ * when it was issued, so it observes all mutations issued before it and none issued after. Mutations (add, remove,
+ * convert) do not wait for running queries: consecutive edge updates are collected into one batch that is published
+ * as a new version before the next query, older versions are freed when their last query finishes.
+ * A batch ends at the next query or convert. It is applied in place if no query still holds the current version,
+ * otherwise it copies the whole graph, so interleaving single edge updates with long running queries costs O(V+E) per
+ * update.
+ * A solve with a timeout answers "ok partial ..." (diameter, feedback arc set) or "error Operation cancelled."
+ * if it runs out of time.
+ *
+ * Requests:
+ *   solve <1|2|3|4|source|diameter|fas|universal> [timeout ms]
+ *   add <u> <v>
+ *   remove <u> <v>
+ *   convert <nlist|flist|amatrix|hybrid>
+ *   stats
+ *   scheduler
+ *   quit
+ */
+export template <typename GraphTypeImplementationGeneralizer>
+class GraphQueryServer {
+private:
+    using vertex_type = typename GraphTypeImplementationGeneralizer::vertex_type;
+    using graph_variant = typename GraphTypeImplementationGeneralizer::graph_variant;
+    using Selector = typename StrategyProvider<GraphTypeImplementationGeneralizer, IAlgorithm<GraphTypeImplementationGeneralizer>, false>::type;
+
+    // in the order of the alternatives of graph_variant
+    static constexpr std::array<std::string_view, 4> implementation_names = {"nlist", "flist", "amatrix", "hybrid"};
+    static_assert(implementation_names.size() == std::variant_size_v<graph_variant>);
+
+    using Versions = VersionedGraph<GraphTypeImplementationGeneralizer>;
+    using Snapshot = typename Versions::snapshot_type;
+
+    Versions graph;
+    typename Versions::batch_type pending; // edge updates not yet published
+    std::ostream& out;
+    std::mutex out_mutex;
+    TaskScheduler& scheduler;
+    TaskGroup queries;
+
+    void respond(size_t seq, std::string_view status, const std::string& payload) {
+        std::lock_guard lock(out_mutex);
+        out << seq << " " << status;
+        if (!payload.empty()) out << " " << payload;
+        out << std::endl;
+    }
+
+    template <typename Problem>
+    static std::string solve(const Snapshot& snapshot, const CancellationToken& token) {
+        auto algo = Selector::template select<Problem>(*snapshot);
+        return formatResultLine(algo->execute(*snapshot, token));
+    }
+
+    static std::string solve(const Snapshot& snapshot, std::string_view problem, const CancellationToken& token) {
+        if (problem == "1" || problem == "source") return solve<Problem::SourceVertexCount>(snapshot, token);
+        if (problem == "2" || problem == "diameter") return solve<Problem::DiameterMeasure>(snapshot, token);
+        if (problem == "3" || problem == "fas") return solve<Problem::FeedbackArcSet>(snapshot, token);
+        if (problem == "4" || problem == "universal") return solve<Problem::FirstUniversalSource>(snapshot, token);
+        throw std::invalid_argument("unknown problem: " + std::string(problem));
+    }
+
+    std::string stats(const Snapshot& snapshot) const {
+        std::ostringstream os;
+        os << "vertices " << +snapshot->numVertices()
+           << " edges " << +snapshot->numEdges()
+           << " implementation " << implementation_names[snapshot->getVariant().index()]
+           << " vertex_bits " << sizeof(vertex_type) * 8
+           << " version " << snapshot.getVersion()
+           << " retained_versions " << graph.retainedVersions();
+        return os.str();
+    }
+
+    std::string scheduler_stats() const {
+        const SchedulerStats scheduler_stats = scheduler.stats();
+        std::ostringstream os;
+        os << "workers " << scheduler.num_workers()
+           << " tasks " << scheduler_stats.tasks_executed
+           << " steals " << scheduler_stats.tasks_stolen
+           << " utilization " << scheduler_stats.utilization;
+        return os.str();
+    }
+
+    template <size_t I = 0>
+    void convert(size_t target) {
+        if constexpr (I < std::variant_size_v<graph_variant>) {
+            if (I == target) {
+                graph.template convert<std::variant_alternative_t<I, graph_variant>>();
+                return;
+            }
+            convert<I + 1>(target);
+        }
+    }
+
+    void convert(std::string_view name) {
+        for (size_t i = 0; i < implementation_names.size(); ++i) {
+            if (implementation_names[i] == name) {
+                convert(i);
+                return;
+            }
+        }
+        throw std::invalid_argument("unknown implementation: " + std::string(name));
+    }
+
+    static std::pair<vertex_type, vertex_type> read_edge(std::istringstream& args, vertex_type num_vertices) {
+        long long u, v;
+        if (!(args >> u >> v)) {
+            throw std::invalid_argument("expected: <u> <v>");
+        }
+        if (u < 0 || u >= num_vertices || v < 0 || v >= num_vertices) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        return {static_cast<vertex_type>(u), static_cast<vertex_type>(v)};
+    }
+
+    void publish() {
+        if (pending.empty()) return;
+        graph.apply(pending);
+        pending = {};
+    }
+
+    // the query gets the snapshot with every mutation issued so far
+    template <typename Query>
+    void run_read(size_t seq, Query query) {
+        publish();
+        queries.run([this, seq, snapshot = graph.snapshot(), query = std::move(query)] {
+            try {
+                respond(seq, "ok", query(snapshot));
+            } catch (const std::exception& e) {
+                respond(seq, "error", e.what());
+            }
+        });
+    }
+
+    template <typename Mutation>
+    void run_mutation(size_t seq, Mutation mutation) {
+        try {
+            mutation();
+            respond(seq, "ok", "");
+        } catch (const std::exception& e) {
+            respond(seq, "error", e.what());
+        }
+    }
+
+public:
+    GraphQueryServer(std::unique_ptr<GraphTypeImplementationGeneralizer> g, std::ostream& os,
+                     TaskScheduler& task_scheduler = TaskScheduler::global())
+        : graph(std::move(*g)), out(os), scheduler(task_scheduler), queries(task_scheduler) {}
+
+    // returns false on quit
+    bool handle(const std::string& line, size_t seq) {
+        std::istringstream args(line);
+        std::string command;
+        if (!(args >> command)) {
+            return true;
+        }
+
+        if (command == "solve") {
+            std::string problem;
+            args >> problem;
+            // the time limit counts from the request, queueing behind other queries included
+            CancellationToken token;
+            if (long long timeout_ms; args >> timeout_ms) {
+                token = CancellationToken::after(std::chrono::milliseconds(timeout_ms));
+            }
+            run_read(seq, [problem, token](const Snapshot& snapshot) { return solve(snapshot, problem, token); });
+        } else if (command == "stats") {
+            run_read(seq, [this](const Snapshot& snapshot) { return stats(snapshot); });
+        } else if (command == "scheduler") {
+            run_read(seq, [this](const Snapshot&) { return scheduler_stats(); });
+        } else if (command == "add" || command == "remove") {
+            // the vertex count never changes, so the update is validated now and applied with its batch
+            run_mutation(seq, [&] {
+                const auto [u, v] = read_edge(args, graph.snapshot()->numVertices());
+                if (command == "add") pending.add(u, v);
+                else pending.remove(u, v);
+            });
+        } else if (command == "convert") {
+            std::string name;
+            args >> name;
+            run_mutation(seq, [&] {
+                publish();
+                convert(name);
+            });
+        } else if (command == "quit") {
+            queries.wait();
+            respond(seq, "ok", "");
+            return false;
+        } else {
+            respond(seq, "error", "unknown command: " + command);
+        }
+        return true;
+    }
+
+    void serve(std::istream& in) {
+        std::string line;
+        size_t seq = 0;
+        while (std::getline(in, line)) {
+            if (!handle(line, ++seq)) {
+                return;
+            }
+        }
+        queries.wait();
+    }
+};
+
+// same format as the normal mode: vertex count, then "u v" pairs until EOF
+AnyImplementedGraph loadGraph(std::istream& in) {
+    long long n;
+    if (!(in >> n) || n < 0) {
+        throw std::invalid_argument("Invalid vertex count.");
+    }
+    // the edge count decides the index types, the edges go into a wide graph that is narrowed at the end
+    auto graph = NarrowestGraphFactory::createWideGraph(static_cast<std::uint64_t>(n));
+    long long u, v;
+    while (in >> u >> v) {
+        if (u < 0 || u >= n || v < 0 || v >= n) {
+            throw std::out_of_range("Invalid vertex index.");
+        }
+        graph->addEdge(static_cast<std::uint32_t>(u), static_cast<std::uint32_t>(v));
+    }
+    return NarrowestGraphFactory::narrow(std::move(graph));
+}
+
+export template <bool isDebugMode>
+int runServerMode(const std::string& graph_path, std::istream& in = std::cin, std::ostream& out = std::cout) {
+    std::ifstream graph_file(graph_path);
+    if (!graph_file.is_open()) {
+        std::cerr << "Failed to open graph file: " << graph_path << std::endl;
+        return 1;
+    }
+    AnyImplementedGraph any_graph;
+    try {
+        any_graph = loadGraph(graph_file);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load graph: " << e.what() << std::endl;
+        return 1;
+    }
+    if constexpr (isDebugMode) {
+        std::cerr << "[DEBUG] Server ready with " << TaskScheduler::global().num_workers() << " workers." << std::endl;
+    }
+    std::visit([&]<typename GraphTypeImplementationGeneralizer>(std::unique_ptr<GraphTypeImplementationGeneralizer>& g) {
+        GraphQueryServer<GraphTypeImplementationGeneralizer> server(std::move(g), out);
+        server.serve(in);
+    }, any_graph);
+    return 0;
+}
@@ -0,0 +1,420 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+export module TaskScheduler;
+
+export struct SchedulerConfig {
+    unsigned num_workers = std::max(1u, std::thread::hardware_concurrency());
+    // worker i is pinned to cpu_affinity[i % size], empty means no pinning (only supported on linux)
+    std::vector<int> cpu_affinity;
+    // indices per task in parallel_for, 0 picks about 4 chunks per worker
+    size_t chunk_size = 0;
+};
+
+export struct WorkerStats {
+    std::uint64_t tasks_executed = 0;
+    std::uint64_t tasks_stolen = 0;
+    std::uint64_t busy_ns = 0;
+};
+
+export struct SchedulerStats {
+    std::vector<WorkerStats> workers;
+    std::uint64_t tasks_executed = 0;
+    std::uint64_t tasks_stolen = 0;
+    double elapsed_sec = 0.0;
+    // busy time of all workers / (elapsed time * worker count)
+    double utilization = 0.0;
+};
+
+/**
+ * @brief Work-stealing scheduler shared by every parallel code path.
+ *
+ * Each worker owns a deque: it pushes and pops its own tasks at the back, idle workers steal from the front of the
+ * others. Tasks submitted from outside the pool go to an injection queue. Threads waiting on a TaskGroup run queued
+ * tasks meanwhile, so parallel loops can be nested (e.g. a parallel strategy inside a server query).
+ */
+export class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::atomic<std::uint64_t> tasks_executed{0};
+        std::atomic<std::uint64_t> tasks_stolen{0};
+        std::atomic<std::uint64_t> busy_ns{0};
+    };
+
+    SchedulerConfig config;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::mutex injection_mutex;
+    std::deque<Task> injection_queue;
+
+    std::atomic<size_t> queued_tasks{0};
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // steady clock ticks, reset_stats() may run while server queries read stats()
+    std::atomic<std::chrono::steady_clock::rep> stats_since{std::chrono::steady_clock::now().time_since_epoch().count()};
+    std::vector<std::jthread> workers;
+
+    static inline thread_local TaskScheduler* current_scheduler = nullptr;
+    static inline thread_local size_t current_worker = 0;
+    // time of the tasks run inside the task running on this thread (while it waits on a TaskGroup)
+    static inline thread_local std::uint64_t nested_busy_ns = 0;
+
+    // global() and configure_global() may race from concurrent library callers, the instance is only touched under the lock
+    struct GlobalInstance {
+        std::mutex mutex;
+        std::unique_ptr<TaskScheduler> scheduler;
+    };
+
+    static GlobalInstance& global_instance() {
+        static GlobalInstance instance;
+        return instance;
+    }
+
+    void pin(std::jthread& worker, size_t index) {
+#ifdef __linux__
+        if (config.cpu_affinity.empty()) return;
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(config.cpu_affinity[index % config.cpu_affinity.size()], &cpu_set);
+        pthread_setaffinity_np(worker.native_handle(), sizeof(cpu_set), &cpu_set);
+#else
+        (void)worker;
+        (void)index;
+#endif
+    }
+
+    std::optional<Task> pop_local(size_t index) {
+        auto& queue = *queues[index];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) return std::nullopt;
+        Task task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return task;
+    }
+
+    std::optional<Task> pop_injected() {
+        std::lock_guard lock(injection_mutex);
+        if (injection_queue.empty()) return std::nullopt;
+        Task task = std::move(injection_queue.front());
+        injection_queue.pop_front();
+        return task;
+    }
+
+    std::optional<Task> steal(size_t thief) {
+        const size_t n = queues.size();
+        for (size_t offset = 1; offset <= n; ++offset) {
+            auto& victim = *queues[(thief + offset) % n];
+            std::lock_guard lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                Task task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // own deque first, then the injection queue, then the other workers
+    std::optional<Task> find_task(std::optional<size_t> worker_index, bool& stolen) {
+        stolen = false;
+        if (worker_index) {
+            if (auto task = pop_local(*worker_index)) return task;
+        }
+        if (auto task = pop_injected()) return task;
+        if (auto task = steal(worker_index.value_or(0))) {
+            stolen = true;
+            return task;
+        }
+        return std::nullopt;
+    }
+
+    void run(Task& task, std::optional<size_t> worker_index, bool stolen) {
+        queued_tasks.fetch_sub(1, std::memory_order_relaxed);
+        if (!worker_index) {
+            task();
+            return;
+        }
+        auto& queue = *queues[*worker_index];
+        const std::uint64_t outer_nested_ns = std::exchange(nested_busy_ns, 0);
+        const auto start = std::chrono::steady_clock::now();
+        task();
+        const auto elapsed_ns = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        // only the task's own time, the nested tasks counted themselves
+        queue.busy_ns.fetch_add(elapsed_ns - std::min(nested_busy_ns, elapsed_ns), std::memory_order_relaxed);
+        nested_busy_ns = outer_nested_ns + elapsed_ns;
+        queue.tasks_executed.fetch_add(1, std::memory_order_relaxed);
+        if (stolen) queue.tasks_stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::optional<size_t> own_worker_index() const {
+        if (current_scheduler == this) return current_worker;
+        return std::nullopt;
+    }
+
+    void worker_loop(size_t index) {
+        current_scheduler = this;
+        current_worker = index;
+        while (true) {
+            bool stolen;
+            if (auto task = find_task(index, stolen)) {
+                run(*task, index, stolen);
+                continue;
+            }
+            std::unique_lock lock(wake_mutex);
+            wake.wait(lock, [this] { return stopping || queued_tasks.load(std::memory_order_relaxed) > 0; });
+            if (stopping && queued_tasks.load(std::memory_order_relaxed) == 0) return;
+        }
+    }
+
+public:
+    explicit TaskScheduler(SchedulerConfig scheduler_config = {}) : config(std::move(scheduler_config)) {
+        config.num_workers = std::max(1u, config.num_workers);
+        queues.reserve(config.num_workers);
+        for (unsigned i = 0; i < config.num_workers; ++i) {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        workers.reserve(config.num_workers);
+        for (unsigned i = 0; i < config.num_workers; ++i) {
+            workers.emplace_back([this, i] { worker_loop(i); });
+            pin(workers.back(), i);
+        }
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    ~TaskScheduler() {
+        {
+            std::lock_guard lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        workers.clear(); // joins, remaining tasks are drained first
+    }
+
+    /**
+     * @brief The scheduler used by the library, created with configure_global()'s config (or the default) on first use.
+     */
+    static TaskScheduler& global() {
+        auto& instance = global_instance();
+        std::lock_guard lock(instance.mutex);
+        if (!instance.scheduler) instance.scheduler = std::make_unique<TaskScheduler>();
+        return *instance.scheduler;
+    }
+
+    // replaces the global scheduler, must not be called while it has work
+    static void configure_global(SchedulerConfig scheduler_config) {
+        auto replacement = std::make_unique<TaskScheduler>(std::move(scheduler_config));
+        auto& instance = global_instance();
+        {
+            std::lock_guard lock(instance.mutex);
+            std::swap(instance.scheduler, replacement);
+        }
+        // the old scheduler joins its workers outside of the lock
+    }
+
+    unsigned num_workers() const {
+        return config.num_workers;
+    }
+
+    size_t chunk_size_for(size_t count) const {
+        if (config.chunk_size > 0) return config.chunk_size;
+        return std::max<size_t>(1, count / (static_cast<size_t>(config.num_workers) * 4));
+    }
+
+    // the task must not throw, TaskGroup::run passes exceptions on to wait()
+    void submit(Task task) {
+        queued_tasks.fetch_add(1, std::memory_order_relaxed);
+        if (const auto worker_index = own_worker_index()) {
+            auto& queue = *queues[*worker_index];
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        } else {
+            std::lock_guard lock(injection_mutex);
+            injection_queue.push_back(std::move(task));
+        }
+        { std::lock_guard lock(wake_mutex); }
+        wake.notify_one();
+    }
+
+    // runs one queued task on the calling thread, returns false if there was none
+    bool try_run_one() {
+        const auto worker_index = own_worker_index();
+        bool stolen;
+        if (auto task = find_task(worker_index, stolen)) {
+            run(*task, worker_index, stolen);
+            return true;
+        }
+        return false;
+    }
+
+    SchedulerStats stats() const {
+        SchedulerStats result;
+        std::uint64_t busy_ns = 0;
+        for (const auto& queue : queues) {
+            WorkerStats worker{queue->tasks_executed.load(std::memory_order_relaxed),
+                               queue->tasks_stolen.load(std::memory_order_relaxed),
+                               queue->busy_ns.load(std::memory_order_relaxed)};
+            result.tasks_executed += worker.tasks_executed;
+            result.tasks_stolen += worker.tasks_stolen;
+            busy_ns += worker.busy_ns;
+            result.workers.push_back(worker);
+        }
+        const std::chrono::steady_clock::time_point since{
+            std::chrono::steady_clock::duration{stats_since.load(std::memory_order_relaxed)}};
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - since;
+        result.elapsed_sec = elapsed.count();
+        if (result.elapsed_sec > 0) {
+            result.utilization = static_cast<double>(busy_ns) / 1e9 / (result.elapsed_sec * config.num_workers);
+        }
+        return result;
+    }
+
+    // not synchronized with running tasks, counts of tasks in flight may land before or after the reset
+    void reset_stats() {
+        for (auto& queue : queues) {
+            queue->tasks_executed.store(0, std::memory_order_relaxed);
+            queue->tasks_stolen.store(0, std::memory_order_relaxed);
+            queue->busy_ns.store(0, std::memory_order_relaxed);
+        }
+        stats_since.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Tasks that can be waited for together. wait() runs queued tasks while the group is not done.
+ * The first exception thrown by a task is rethrown by wait(), the other tasks still run.
+ */
+export class TaskGroup {
+private:
+    TaskScheduler& scheduler;
+    std::atomic<size_t> pending{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    void wait_until_done() {
+        size_t remaining;
+        while ((remaining = pending.load(std::memory_order_acquire)) != 0) {
+            if (!scheduler.try_run_one()) {
+                pending.wait(remaining, std::memory_order_acquire);
+            }
+        }
+    }
+
+public:
+    explicit TaskGroup(TaskScheduler& task_scheduler = TaskScheduler::global()) : scheduler(task_scheduler) {}
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // an exception nobody waited for is dropped
+    ~TaskGroup() {
+        wait_until_done();
+    }
+
+    void run(TaskScheduler::Task task) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        scheduler.submit([this, task = std::move(task)] {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard lock(error_mutex);
+                if (!error) error = std::current_exception();
+            }
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                pending.notify_all();
+            }
+        });
+    }
+
+    void wait() {
+        wait_until_done();
+        std::exception_ptr first;
+        {
+            std::lock_guard lock(error_mutex);
+            first = std::exchange(error, nullptr);
+        }
+        if (first) std::rethrow_exception(first);
+    }
+};
+
+/**
+ * @brief Calls body(chunk_begin, chunk_end) for chunks of [begin, end) on the scheduler, returns when all are done.
+ * The chunk size comes from the SchedulerConfig unless given.
+ */
+export template <typename Index, typename ChunkBody>
+void parallel_for_chunks(Index begin, Index end, ChunkBody body, size_t chunk_size = 0,
+                         TaskScheduler& scheduler = TaskScheduler::global()) {
+    if (end <= begin) return;
+    const size_t count = static_cast<size_t>(end - begin);
+    const size_t chunk = chunk_size > 0 ? chunk_size : scheduler.chunk_size_for(count);
+    if (chunk >= count) {
+        body(begin, end);
+        return;
+    }
+    TaskGroup group(scheduler);
+    for (size_t offset = 0; offset < count; offset += chunk) {
+        const Index chunk_begin = begin + static_cast<Index>(offset);
+        const Index chunk_end = begin + static_cast<Index>(std::min(count, offset + chunk));
+        group.run([&body, chunk_begin, chunk_end] { body(chunk_begin, chunk_end); });
+    }
+    group.wait();
+}
+
+export template <typename Index, typename Body>
+void parallel_for(Index begin, Index end, Body body, size_t chunk_size = 0,
+                  TaskScheduler& scheduler = TaskScheduler::global()) {
+    parallel_for_chunks(begin, end, [&body](Index chunk_begin, Index chunk_end) {
+        for (Index i = chunk_begin; i < chunk_end; ++i) {
+            body(i);
+        }
+    }, chunk_size, scheduler);
+}
+
+/**
+ * @brief reduce(init, transform(i)...) over [begin, end), chunks are reduced locally and then combined in order.
+ */
+export template <typename Index, typename T, typename Reduce, typename Transform>
+T parallel_transform_reduce(Index begin, Index end, T init, Reduce reduce, Transform transform, size_t chunk_size = 0,
+                            TaskScheduler& scheduler = TaskScheduler::global()) {
+    if (end <= begin) return init;
+    const size_t count = static_cast<size_t>(end - begin);
+    const size_t chunk = chunk_size > 0 ? chunk_size : scheduler.chunk_size_for(count);
+    std::vector<std::optional<T>> partials((count + chunk - 1) / chunk);
+    parallel_for_chunks(begin, end, [&](Index chunk_begin, Index chunk_end) {
+        T local = transform(chunk_begin);
+        for (Index i = chunk_begin + 1; i < chunk_end; ++i) {
+            local = reduce(std::move(local), transform(i));
+        }
+        partials[static_cast<size_t>(chunk_begin - begin) / chunk] = std::move(local);
+    }, chunk, scheduler);
+    for (auto& partial : partials) {
+        init = reduce(std::move(init), std::move(*partial));
+    }
+    return init;
+}
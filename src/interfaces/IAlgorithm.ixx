@@ -1,13 +1,15 @@
 export module IAlgorithm;
 
 import AlgorithmResult;
-class ImplementedGraph;
+import ImplementedGraph;
+import Cancellation;
 
 export template <typename GraphTypeImplementationGeneralizer = ImplementedGraph>
 class IAlgorithm {
 public:
     virtual ~IAlgorithm() = default;
-    virtual AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g) const = 0;
+    // overriders repeat the default argument, so calls through the concrete type can omit the token as well
+    virtual AlgoResultVariant execute(const GraphTypeImplementationGeneralizer& g, const CancellationToken& token = {}) const = 0;
     virtual const char* getName() const = 0;
 
     using implementation_generalizer_type = GraphTypeImplementationGeneralizer;
@@ -5,31 +5,35 @@ module;
 
 export module IGraph;
 
-export class IGraph {
+import GraphConcepts;
+
+export template <VertexIndex VertexId = int, EdgeIndex EdgeOffset = int>
+class BasicIGraph {
 public:
-    IGraph();
-    virtual ~IGraph();
-
-    IGraph(const IGraph &);
-    IGraph(IGraph &&);
-    IGraph &operator=(const IGraph &);
-    IGraph &operator=(IGraph &&);
-
-    virtual int numVertices() const = 0;
-    virtual int numEdges() const = 0;
-    virtual void addEdge(int u, int v) = 0;
-    virtual void removeEdge(int u, int v) = 0;
-    virtual std::span<const int> outneighbors(int u) const = 0;
-    virtual std::span<const int> inneighbors(int u) const = 0;
-    virtual int out_degree(int u) const = 0;
-    virtual int in_degree(int u) const = 0;
+    using vertex_type = VertexId;
+    using edge_offset_type = EdgeOffset;
+
+    BasicIGraph() = default;
+    virtual ~BasicIGraph() = default;
+
+    BasicIGraph(const BasicIGraph &) = default;
+    BasicIGraph(BasicIGraph &&) = default;
+    BasicIGraph &operator=(const BasicIGraph &) = default;
+    BasicIGraph &operator=(BasicIGraph &&) = default;
+
+    virtual VertexId numVertices() const = 0;
+    virtual EdgeOffset numEdges() const = 0;
+    virtual void addEdge(VertexId u, VertexId v) = 0;
+    virtual void removeEdge(VertexId u, VertexId v) = 0;
+    virtual std::span<const VertexId> outneighbors(VertexId u) const = 0;
+    virtual std::span<const VertexId> inneighbors(VertexId u) const = 0;
+    virtual EdgeOffset out_degree(VertexId u) const = 0;
+    virtual EdgeOffset in_degree(VertexId u) const = 0;
+    // degrees of all vertices (index u holds the degree of u), valid until the next mutation
+    virtual std::span<const EdgeOffset> out_degrees() const = 0;
+    virtual std::span<const EdgeOffset> in_degrees() const = 0;
+    virtual bool has_edge(VertexId u, VertexId v) const = 0;
     // virtual IGraph& getTranspose() const = 0;
 };
 
-//linker problems
-inline IGraph::IGraph() = default;
-inline IGraph::~IGraph() = default;
-inline IGraph::IGraph(const IGraph &) = default;
-inline IGraph::IGraph(IGraph &&) = default;
-inline IGraph &IGraph::operator=(const IGraph &) = default;
-inline IGraph &IGraph::operator=(IGraph &&) = default;
\ No newline at end of file
+export using IGraph = BasicIGraph<int, int>;
@@ -11,6 +11,12 @@
 #include <optional>
 #include <cmath>
 #include <sstream>
+#include <memory>
+#include <utility>
+#include <variant>
+#include <thread>
+#include <array>
+#include <cstdint>
 
 #if !defined(__cplusplus) || __cplusplus < 202302L
 #error This code requires C++23 or later.
@@ -44,8 +50,16 @@ import GraphProcessorAlgorithmStrategyFactory;
 import Profiler;
 import StrategyProvider;
 import Properties;
+import QueryServer;
+import TaskScheduler;
+import AnalysisPipeline;
+import Cancellation;
+import SemiExternal;
 
-[[noreturn]] auto autoInvocation(std::unique_ptr<ImplementedGraph> g) -> void;
+template <typename GraphTypeImplementationGeneralizer>
+[[noreturn]] auto autoInvocation(std::unique_ptr<GraphTypeImplementationGeneralizer> g, const CancellationToken& token) -> void;
+template <typename GraphTypeImplementationGeneralizer>
+auto runAllAlgorithms(const GraphTypeImplementationGeneralizer& g) -> void;
 
 auto getProfilingLevel(const std::vector<std::string_view>& args) -> int {
     int profilingLevel = 3;
@@ -86,6 +100,51 @@ auto getProfilingLevel(const std::vector<std::string_view>& args) -> int {
     return profilingLevel;
 }
 
+auto getWorkerCount(const std::vector<std::string_view>& args) -> unsigned {
+    const auto workersIt = std::ranges::find(args, "--workers");
+    if (workersIt == args.end() || workersIt + 1 == args.end()) {
+        const unsigned num_cores = std::thread::hardware_concurrency();
+        return num_cores > 0 ? num_cores : 4;
+    }
+    try {
+        const int workers = std::stoi(std::string(*(workersIt + 1)));
+        if (workers > 0) return static_cast<unsigned>(workers);
+    } catch (const std::exception& e) {
+    }
+    std::cerr << "Worker count bad" << std::endl;
+    exit(1);
+}
+
+// --workers N sets the size of the shared task scheduler, --pin pins worker i to cpu i
+auto getSchedulerConfig(const std::vector<std::string_view>& args) -> SchedulerConfig {
+    SchedulerConfig config;
+    config.num_workers = getWorkerCount(args);
+    if (std::ranges::find(args, "--pin") != args.end()) {
+        const unsigned num_cores = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < config.num_workers; ++i) {
+            config.cpu_affinity.push_back(static_cast<int>(i % num_cores));
+        }
+    }
+    return config;
+}
+
+// --timeout <ms> bounds the normal mode, the slow problems then print partial results
+auto getTimeout(const std::vector<std::string_view>& args) -> CancellationToken {
+    const auto timeoutIt = std::ranges::find(args, "--timeout");
+    if (timeoutIt == args.end()) {
+        return CancellationToken{};
+    }
+    try {
+        if (timeoutIt + 1 != args.end()) {
+            const long long timeout_ms = std::stoll(std::string(*(timeoutIt + 1)));
+            if (timeout_ms >= 0) return CancellationToken::after(std::chrono::milliseconds(timeout_ms));
+        }
+    } catch (const std::exception& e) {
+    }
+    std::cerr << "Timeout bad" << std::endl;
+    exit(1);
+}
+
 int main(int argc, char* argv[]) {
     const std::vector<std::string_view> args(argv + 1, argv + argc);
     const bool isGeneratorMode = std::ranges::find(args, "--generator") != args.end();
@@ -117,11 +176,32 @@ int main(int argc, char* argv[]) {
 
 
 
+    TaskScheduler::configure_global(getSchedulerConfig(args));
+
     if (isProfilingMode) {
-        runProfilingMode<isDebugMode>(profilingLevel, true);
+        // --memory-resources repeats the profiling with each memory resource configuration
+        const bool compareMemoryResources = std::ranges::find(args, "--memory-resources") != args.end();
+        runProfilingMode<isDebugMode>(profilingLevel, true, compareMemoryResources);
         return 0;
     }
 
+    if (const auto serverIt = std::ranges::find(args, "--server"); serverIt != args.end()) {
+        if (serverIt + 1 == args.end()) {
+            std::cerr << "Usage: --server <graph file> [--workers N] [--pin]" << std::endl;
+            return 1;
+        }
+        return runServerMode<isDebugMode>(std::string(*(serverIt + 1)));
+    }
+
+    // --semi-external <file>: the adjacency stays on disk, for graphs that do not fit into memory
+    if (const auto semiExternalIt = std::ranges::find(args, "--semi-external"); semiExternalIt != args.end()) {
+        if (semiExternalIt + 1 == args.end()) {
+            std::cerr << "Usage: --semi-external <graph file or CSR file>" << std::endl;
+            return 1;
+        }
+        return runSemiExternalMode<isDebugMode>(std::string(*(semiExternalIt + 1)));
+    }
+
 
     if (isDebugMode) {
         std::cout << "[DEBUG] Debug mode enabled.\n\n";
@@ -134,77 +214,95 @@ int main(int argc, char* argv[]) {
         std::cerr << "Invalid vertex count." << std::endl;
         return 1;
     }
-    auto g = GraphFactory<ImplementedGraph>::createGraph<GraphNList>(n);
-    if (!g) {
-        std::cerr << "Graph creation failed";
-        return 1;
-    }
     if (isDebugMode) std::cout << "\n[DEBUG] Edges (u v pairs), to finish type EOF (Ctrl+D Linux/macOS, Ctrl+Z Windows):" << std::endl;
-    int u, v;
+    // the edge count decides the index types, the edges go into a wide graph that is narrowed at the end
+    auto wide_graph = NarrowestGraphFactory::createWideGraph(static_cast<std::uint64_t>(n));
+    long long u, v;
     while (std::cin >> u >> v) {
-        g->addEdge(u, v);
+        if (u < 0 || u >= n || v < 0 || v >= n) {
+            std::cerr << "Invalid vertex index." << std::endl;
+            return 1;
+        }
+        wide_graph->addEdge(static_cast<std::uint32_t>(u), static_cast<std::uint32_t>(v));
     }
     std::cin.clear();
 
-    if (isDebugMode) std::cout << "\n[DEBUG] Graph structure:\n" << *g << "\n";
+    AnyImplementedGraph any_graph = NarrowestGraphFactory::narrow(std::move(wide_graph));
+    const CancellationToken token = getTimeout(args);
+    std::visit([&token]<typename GraphTypeImplementationGeneralizer>(std::unique_ptr<GraphTypeImplementationGeneralizer>& g) {
+        if (!g) {
+            std::cerr << "Graph creation failed";
+            exit(1);
+        }
+
+        if (isDebugMode) std::cout << "\n[DEBUG] Graph structure:\n" << *g << "\n";
+
+        if (isDebugMode) std::cout << "autoinvocation" << std::endl;
+        autoInvocation(std::move(g), token);
 
-    if (isDebugMode) std::cout << "autoinvocation" << std::endl;
-    autoInvocation(std::move(g));
+        runAllAlgorithms(*g);
+    }, any_graph);
 
-    using ProcessorType = GraphProcessor<ImplementedGraph, IAlgorithm<ImplementedGraph>, isDebugMode>;
+    return 0;
+}
+
+template <typename GraphTypeImplementationGeneralizer>
+auto runAllAlgorithms(const GraphTypeImplementationGeneralizer& g) -> void {
+    constexpr bool isDebugMode =
+#ifdef DEBUG
+    true;
+#else
+    false;
+#endif
+    using ProcessorType = GraphProcessor<GraphTypeImplementationGeneralizer, IAlgorithm<GraphTypeImplementationGeneralizer>, isDebugMode>;
     ProcessorType processor;
 
-    std::vector<std::unique_ptr<IAlgorithm<ImplementedGraph>>> algorithms_to_run;
-
-    algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::SourceVertexStrategy>());
-    if (isDebugMode) algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::SequentialDiameterStrategy>());
-    algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::AsyncDiameterStrategy>());
-    if (isDebugMode) algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::ParallelDiameterStrategy>());
-    algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::FeedbackArcSetRemoveCyclesStrategy>());
-    algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::FeedbackArcSetInsertEdgesStrategy>());
-    algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::FeedbackArcSetDfsStrategy>());
-    if (isDebugMode) algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::SequentialUniversalSourceFinderStrategy>());
-    if (isDebugMode) algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::ParallelUniversalSourceFinderStrategy>());
-    algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::KosarajuUniversalSourceFinderStrategy>());
-    algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::TarjanUniversalSourceFinderStrategy>());
-    algorithms_to_run.push_back(make_decorated_algorithm<ProcessorType::PathBasedUniversalSourceFinderStrategy>());
+    std::vector<std::unique_ptr<IAlgorithm<GraphTypeImplementationGeneralizer>>> algorithms_to_run;
+
+    algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::SourceVertexStrategy>());
+    if (isDebugMode) algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::SequentialDiameterStrategy>());
+    algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::AsyncDiameterStrategy>());
+    if (isDebugMode) algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::ParallelDiameterStrategy>());
+    algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::FeedbackArcSetRemoveCyclesStrategy>());
+    algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::FeedbackArcSetInsertEdgesStrategy>());
+    algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::FeedbackArcSetDfsStrategy>());
+    if (isDebugMode) algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::SequentialUniversalSourceFinderStrategy>());
+    if (isDebugMode) algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::ParallelUniversalSourceFinderStrategy>());
+    algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::KosarajuUniversalSourceFinderStrategy>());
+    algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::TarjanUniversalSourceFinderStrategy>());
+    algorithms_to_run.push_back(make_decorated_algorithm<typename ProcessorType::PathBasedUniversalSourceFinderStrategy>());
 
     for (const auto& algo : algorithms_to_run) {
-        auto result = algo->execute(*g);
+        auto result = algo->execute(g);
         printResult<std::ostream>(result, std::cout);
     }
-    // g->convertTo<GraphFList>();
+    // g.convertTo<GraphFList>();
     // for (const auto& algo : algorithms_to_run) {
-    //     auto result = algo->execute(*g);
+    //     auto result = algo->execute(g);
     //     printResult<std::ostream>(result, std::cout);
     // }
-
-    return 0;
 }
 
-[[noreturn]] auto autoInvocation(std::unique_ptr<ImplementedGraph> g) -> void {
+template <typename GraphTypeImplementationGeneralizer>
+[[noreturn]] auto autoInvocation(std::unique_ptr<GraphTypeImplementationGeneralizer> g, const CancellationToken& token) -> void {
     constexpr bool isDebugMode =
 #ifdef DEBUG
     true;
 #else
     false;
 #endif
-    using StandardStrategySelector = typename StrategyProvider<ImplementedGraph, IAlgorithm<ImplementedGraph>, isDebugMode>::type;
-
-    if (isDebugMode) std::cout << "\n--- Solving Problem 1: Source Vertex Count ---\n";
-    auto p1_result = StandardStrategySelector::solve<Problem::SourceVertexCount, isDebugMode>(*g);
-    printResult(p1_result);
-
-    if (isDebugMode) std::cout << "\n--- Solving Problem 2: Diameter Measure ---\n";
-    auto p2_result = StandardStrategySelector::solve<Problem::DiameterMeasure, isDebugMode>(*g);
-    printResult(p2_result);
+    constexpr std::array<const char*, 4> problem_titles = {
+        "Source Vertex Count", "Diameter Measure", "Feedback Arc Set", "First Universal Source"};
 
-    if (isDebugMode) std::cout << "\n--- Solving Problem 3: Feedback Arc Set ---\n";
-    auto p3_result = StandardStrategySelector::solve<Problem::FeedbackArcSet, isDebugMode>(*g);
-    printResult(p3_result);
-
-    if (isDebugMode) std::cout << "\n--- Solving Problem 4: First Universal Source ---\n";
-    auto p4_result = StandardStrategySelector::solve<Problem::FirstUniversalSource, isDebugMode>(*g);
-    printResult(p4_result);
+    // the four problems run concurrently and share the degrees and the scc decomposition
+    AnalysisPipeline<GraphTypeImplementationGeneralizer> pipeline(*g);
+    const auto results = pipeline.run(token);
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (isDebugMode) std::cout << "\n--- Solving Problem " << i + 1 << ": " << problem_titles[i] << " ---\n";
+        std::cout << results[i].name << ":" << std::endl;
+        std::cout << "time: " << std::fixed << std::setprecision(9) << results[i].elapsed_sec << "s\n";
+        printResult(results[i].result);
+    }
+    if (isDebugMode) std::cout << "\n[DEBUG] Shared artifacts computed: " << pipeline.computed_artifact_count() << std::endl;
     exit(0);
 }
\ No newline at end of file
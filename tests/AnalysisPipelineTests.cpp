@@ -0,0 +1,103 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <variant>
+#include <random>
+
+#include "GraphTestUtils.hpp"
+
+import ImplementedGraph;
+import GraphNList;
+import GraphFList;
+import GraphAMatrix;
+import GraphFactory;
+import GraphAlgo;
+import AlgorithmResult;
+import AnalysisPipeline;
+import Generator;
+
+TEMPLATE_TEST_CASE("Analysis pipeline", "[pipeline]", GraphNList, GraphFList, GraphAMatrix) {
+    using GraphType = TestType;
+    using Processor = GraphProcessor<ImplementedGraph>;
+    using FAS = std::vector<std::pair<int, int>>;
+
+    SECTION("Artifacts are computed once and shared") {
+        auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(5);
+        g->addEdge(0, 1);
+        g->addEdge(1, 2);
+        g->addEdge(2, 0);
+        g->addEdge(2, 3);
+        g->addEdge(3, 4);
+        g->addEdge(4, 4);
+
+        AnalysisPipeline<ImplementedGraph> pipeline(*g);
+        REQUIRE(pipeline.computed_artifact_count() == 0);
+        const auto results = pipeline.run();
+        REQUIRE(pipeline.computed_artifact_count() == 3);
+
+        REQUIRE(std::get<std::vector<int>>(results[0].result).empty());
+        REQUIRE(std::get<int>(results[1].result) == -1);
+        const auto& fas = std::get<FAS>(results[2].result);
+        REQUIRE(fas.size() == 2);
+        REQUIRE(is_acyclic_without(*g, fas));
+        REQUIRE(std::get<int>(results[3].result) == 0);
+
+        REQUIRE(pipeline.scc().scc_count == 3);
+        const auto& order = pipeline.topological_order();
+        REQUIRE(order.size() == 3);
+        REQUIRE(pipeline.scc().scc_map[0] == order[0]);
+        REQUIRE(pipeline.scc().scc_map[4] == order[2]);
+
+        pipeline.run();
+        REQUIRE(pipeline.computed_artifact_count() == 3);
+    }
+
+    SECTION("Only the artifacts a problem needs are computed") {
+        auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(3);
+        g->addEdge(0, 1);
+        AnalysisPipeline<ImplementedGraph> pipeline(*g);
+        // the sources come straight from the in-degrees of the graph
+        REQUIRE(std::get<std::vector<int>>(pipeline.source_vertices()) == std::vector<int>{0, 2});
+        REQUIRE(pipeline.computed_artifact_count() == 0);
+        REQUIRE(std::get<int>(pipeline.diameter()) == -1);
+        REQUIRE(pipeline.computed_artifact_count() == 1);
+    }
+
+    SECTION("Empty and single vertex graphs") {
+        auto empty = GraphFactory<ImplementedGraph>::createGraph<GraphType>(0);
+        const auto empty_results = AnalysisPipeline<ImplementedGraph>(*empty).run();
+        REQUIRE(std::get<std::vector<int>>(empty_results[0].result).empty());
+        REQUIRE(std::get<int>(empty_results[1].result) == 0);
+        REQUIRE(std::get<FAS>(empty_results[2].result).empty());
+        REQUIRE(std::get<int>(empty_results[3].result) == -1);
+
+        auto single = GraphFactory<ImplementedGraph>::createGraph<GraphType>(1);
+        const auto single_results = AnalysisPipeline<ImplementedGraph>(*single).run();
+        REQUIRE(std::get<std::vector<int>>(single_results[0].result) == std::vector<int>{0});
+        REQUIRE(std::get<int>(single_results[1].result) == 0);
+        REQUIRE(std::get<int>(single_results[3].result) == 0);
+    }
+
+    SECTION("Randomized graph checks against the strategies") {
+        constexpr int num_tests = 20;
+        constexpr int num_vertices = 15;
+
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<> edge_dist(5, 80);
+
+        for (int i = 0; i < num_tests; ++i) {
+            auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(num_vertices);
+            for (const auto& [u, v] : generate_erdos_renyi_edges(num_vertices, edge_dist(gen))) {
+                g->addEdge(u, v);
+            }
+            const auto results = AnalysisPipeline<ImplementedGraph>(*g).run();
+
+            REQUIRE(results[0].result == Processor::SourceVertexStrategy().execute(*g));
+            REQUIRE(results[1].result == Processor::SequentialDiameterStrategy().execute(*g));
+            REQUIRE(is_acyclic_without(*g, std::get<FAS>(results[2].result)));
+            REQUIRE(results[3].result == Processor::TarjanUniversalSourceFinderStrategy().execute(*g));
+        }
+    }
+}
@@ -0,0 +1,132 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <variant>
+#include <random>
+#include <string>
+#include <chrono>
+#include <stop_token>
+
+#include "GraphTestUtils.hpp"
+
+import ImplementedGraph;
+import GraphNList;
+import GraphFList;
+import GraphAMatrix;
+import GraphFactory;
+import GraphAlgo;
+import AlgorithmResult;
+import AnalysisPipeline;
+import Cancellation;
+import Generator;
+
+namespace {
+    using FAS = std::vector<std::pair<int, int>>;
+
+    CancellationToken stopped_token() {
+        std::stop_source source;
+        source.request_stop();
+        return CancellationToken(source.get_token());
+    }
+}
+
+TEMPLATE_TEST_CASE("Cancellation", "[cancellation]", GraphNList, GraphFList, GraphAMatrix) {
+    using GraphType = TestType;
+    using Processor = GraphProcessor<ImplementedGraph>;
+
+    SECTION("Tokens") {
+        REQUIRE_FALSE(CancellationToken{}.stop_requested());
+        REQUIRE_FALSE(CancellationToken{}.can_be_stopped());
+        REQUIRE(stopped_token().stop_requested());
+        REQUIRE(CancellationToken::after(std::chrono::milliseconds(0)).stop_requested());
+        REQUIRE_FALSE(CancellationToken::after(std::chrono::hours(1)).stop_requested());
+        REQUIRE(CancellationToken::after(std::chrono::hours(1)).with_deadline(CancellationToken::clock::now()).stop_requested());
+        REQUIRE_THROWS_AS(stopped_token().throw_if_stop_requested(), OperationCancelled);
+    }
+
+    // strongly connected, so only a cancellation can make the diameter partial
+    auto cycle = GraphFactory<ImplementedGraph>::createGraph<GraphType>(6);
+    for (int i = 0; i < 6; ++i) {
+        cycle->addEdge(i, (i + 1) % 6);
+    }
+    cycle->addEdge(0, 3);
+
+    SECTION("Diameter strategies give a lower bound") {
+        const CancellationToken token = stopped_token();
+        REQUIRE(std::get<PartialResult<int>>(Processor::SequentialDiameterStrategy().execute(*cycle, token)).value <= 5);
+        REQUIRE(std::get<PartialResult<int>>(Processor::AsyncDiameterStrategy().execute(*cycle, token)).value <= 5);
+        REQUIRE(std::get<PartialResult<int>>(Processor::ParallelDiameterStrategy().execute(*cycle, token)).value <= 5);
+        REQUIRE(isPartial(Processor::ParallelDiameterStrategy().execute(*cycle, token)));
+        REQUIRE(formatResultLine(PartialResult<int>{3}) == "partial 3");
+    }
+
+    SECTION("Exact strategies abort") {
+        const CancellationToken token = stopped_token();
+        REQUIRE_THROWS_AS(Processor::SourceVertexStrategy().execute(*cycle, token), OperationCancelled);
+        REQUIRE_THROWS_AS(Processor::ParallelUniversalSourceFinderStrategy().execute(*cycle, token), OperationCancelled);
+        REQUIRE_THROWS_AS(Processor::KosarajuUniversalSourceFinderStrategy().execute(*cycle, token), OperationCancelled);
+        REQUIRE_THROWS_AS(Processor::TarjanUniversalSourceFinderStrategy().execute(*cycle, token), OperationCancelled);
+        REQUIRE_THROWS_AS(Processor::PathBasedUniversalSourceFinderStrategy().execute(*cycle, token), OperationCancelled);
+    }
+
+    SECTION("A token that does not stop changes nothing") {
+        const CancellationToken token = CancellationToken::after(std::chrono::hours(1));
+        REQUIRE(std::get<int>(Processor::AsyncDiameterStrategy().execute(*cycle, token)) == 5);
+        REQUIRE(std::get<int>(Processor::ParallelDiameterStrategy().execute(*cycle, token)) == 5);
+        REQUIRE(std::get<int>(Processor::TarjanUniversalSourceFinderStrategy().execute(*cycle, token)) == 0);
+        REQUIRE_FALSE(isPartial(Processor::FeedbackArcSetInsertEdgesStrategy().execute(*cycle, token)));
+    }
+
+    SECTION("Partial feedback arc sets still break every cycle") {
+        constexpr int num_tests = 10;
+        constexpr int num_vertices = 12;
+
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<> edge_dist(6, 60);
+
+        const CancellationToken token = stopped_token();
+        for (int i = 0; i < num_tests; ++i) {
+            auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(num_vertices);
+            for (const auto& [u, v] : generate_erdos_renyi_edges(num_vertices, edge_dist(gen))) {
+                g->addEdge(u, v);
+            }
+            for (const auto& result : {Processor::FeedbackArcSetRemoveCyclesStrategy().execute(*g, token),
+                                       Processor::FeedbackArcSetInsertEdgesStrategy().execute(*g, token),
+                                       Processor::FeedbackArcSetDfsStrategy().execute(*g, token)}) {
+                REQUIRE(is_acyclic_without(*g, std::get<PartialResult<FAS>>(result).value));
+            }
+
+            const auto results = AnalysisPipeline<ImplementedGraph>(*g).run(token);
+            REQUIRE(std::get<std::string>(results[0].result) == "cancelled");
+            REQUIRE(is_acyclic_without(*g, std::get<PartialResult<FAS>>(results[2].result).value));
+            REQUIRE(std::get<std::string>(results[3].result) == "cancelled");
+        }
+    }
+}
+
+TEST_CASE("A deadline stops a DFS within its root", "[cancellation]") {
+    using Processor = GraphProcessor<ImplementedGraph>;
+    // a binary tree with the edges in both directions: strongly connected, one DFS root covers all of it
+    constexpr int num_vertices = (1 << 21) - 1;
+    auto g = GraphFactory<ImplementedGraph>::createGraph<GraphNList>(num_vertices);
+    for (int u = 1; u < num_vertices; ++u) {
+        g->addEdge((u - 1) / 2, u);
+        g->addEdge(u, (u - 1) / 2);
+    }
+    // a third of an uncancelled run: past the allocations, well before the DFS is done
+    const auto start = CancellationToken::clock::now();
+    REQUIRE(Processor::strongly_connected_components(*g).scc_count == 1);
+    const auto run_time = CancellationToken::clock::now() - start;
+    auto soon = [&] { return CancellationToken::after(run_time / 3); };
+
+    REQUIRE_THROWS_AS(Processor::strongly_connected_components(*g, soon()), OperationCancelled);
+    REQUIRE_THROWS_AS(AnalysisPipeline<ImplementedGraph>(*g).scc(soon()), OperationCancelled);
+    REQUIRE_THROWS_AS(Processor::KosarajuUniversalSourceFinderStrategy().execute(*g, soon()), OperationCancelled);
+    REQUIRE_THROWS_AS(Processor::PathBasedUniversalSourceFinderStrategy().execute(*g, soon()), OperationCancelled);
+
+    const auto fas = Processor::FeedbackArcSetDfsStrategy().execute(*g, soon());
+    REQUIRE(isPartial(fas));
+    REQUIRE(is_acyclic_without(*g, std::get<PartialResult<FAS>>(fas).value));
+}
@@ -0,0 +1,95 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <vector>
+#include <utility>
+#include <memory>
+#include <random>
+#include <span>
+
+import ImplementedGraph;
+import GraphNList;
+import GraphFList;
+import GraphAMatrix;
+import GraphHybrid;
+import GraphFactory;
+import DegreeKernels;
+import Generator;
+
+TEMPLATE_TEST_CASE("Degree arrays", "[degrees]", GraphNList, GraphFList, GraphAMatrix, GraphHybrid) {
+    using GraphType = TestType;
+
+    SECTION("Degree arrays follow the mutations") {
+        constexpr int num_vertices = 30;
+        std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<> edge_dist(0, 200);
+
+        auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(num_vertices);
+        const auto edges = generate_erdos_renyi_edges(num_vertices, edge_dist(gen));
+        for (const auto& [u, v] : edges) {
+            g->addEdge(u, v);
+        }
+        for (size_t i = 0; i < edges.size(); i += 3) {
+            g->removeEdge(edges[i].first, edges[i].second);
+        }
+        g->removeEdge(0, 0); // not an edge, changes nothing
+
+        const auto transpose = g->getTranspose();
+        for (const auto& graph : {*g, transpose}) {
+            const auto out = graph.out_degrees();
+            const auto in = graph.in_degrees();
+            REQUIRE(out.size() == num_vertices);
+            REQUIRE(in.size() == num_vertices);
+            for (int u = 0; u < num_vertices; ++u) {
+                REQUIRE(out[u] == static_cast<int>(graph.outneighbors(u).size()));
+                REQUIRE(in[u] == static_cast<int>(graph.inneighbors(u).size()));
+            }
+        }
+        const auto converted = ImplementedGraph(GraphFList(*g));
+        REQUIRE(std::ranges::equal(converted.in_degrees(), g->in_degrees()));
+    }
+
+    SECTION("Kernels on a small graph") {
+        auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(5);
+        g->addEdge(0, 1);
+        g->addEdge(0, 2);
+        g->addEdge(1, 2);
+        g->addEdge(3, 3);
+
+        REQUIRE(zero_degree_vertices<int>(g->in_degrees()) == std::vector<int>{0, 4});
+        REQUIRE(zero_degree_vertices<int>(g->out_degrees()) == std::vector<int>{2, 4});
+        REQUIRE(count_zero_degrees(g->in_degrees()) == 2);
+        REQUIRE(degree_difference(g->out_degrees(), g->in_degrees()) == std::vector<long>{2, 0, -2, 0, 0});
+        REQUIRE(degree_histogram(g->in_degrees()) == std::vector<size_t>{2, 2, 1});
+        REQUIRE(max_degree(g->out_degrees()) == 2);
+    }
+}
+
+TEST_CASE("Degree kernels on long arrays", "[degrees]") {
+    // long enough to be split into chunks, with zeros on block and chunk boundaries
+    constexpr size_t count = 200003;
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<> degree_dist(0, 40);
+    std::vector<int> out(count), in(count);
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = degree_dist(gen) % 7;
+        in[i] = degree_dist(gen);
+    }
+    in[0] = in[15] = in[16] = in[16384] = in[count - 1] = 0;
+
+    std::vector<int> expected_zeros;
+    std::vector<long> expected_difference(count);
+    std::vector<size_t> expected_histogram(41, 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (in[i] == 0) expected_zeros.push_back(static_cast<int>(i));
+        expected_difference[i] = out[i] - in[i];
+        ++expected_histogram[in[i]];
+    }
+    while (expected_histogram.back() == 0) expected_histogram.pop_back();
+
+    const std::span<const int> in_span(in), out_span(out);
+    REQUIRE(zero_degree_vertices<int>(in_span) == expected_zeros);
+    REQUIRE(count_zero_degrees(in_span) == expected_zeros.size());
+    REQUIRE(degree_difference(out_span, in_span) == expected_difference);
+    REQUIRE(degree_histogram(in_span) == expected_histogram);
+    REQUIRE(degree_histogram(std::span<const int>()).empty());
+    REQUIRE(zero_degree_vertices<int>(std::span<const int>()).empty());
+}
@@ -7,45 +7,19 @@
 #include <variant>
 #include <functional>
 
+#include "GraphTestUtils.hpp"
+
 import ImplementedGraph;
 import GraphNList;
 import GraphFList;
 import GraphAMatrix;
+import GraphHybrid;
 import GraphFactory;
 import GraphAlgo;
 import AlgorithmResult;
 import IAlgorithm;
 
-bool is_dag_after_removal(const ImplementedGraph& original_graph, const std::vector<std::pair<int, int>>& fas) {
-    auto g_copy = original_graph;
-    for (const auto& edge : fas) {
-        g_copy.removeEdge(edge.first, edge.second);
-    }
-
-    enum class Color { WHITE, GRAY, BLACK };
-    std::vector<Color> colors(g_copy.numVertices(), Color::WHITE);
-
-    std::function<bool(int)> has_cycle_util =
-        [&](int u) -> bool {
-        colors[u] = Color::GRAY;
-        for (int v : g_copy.outneighbors(u)) {
-            if (colors[v] == Color::GRAY) return true;
-            if (colors[v] == Color::WHITE && has_cycle_util(v)) return true;
-        }
-        colors[u] = Color::BLACK;
-        return false;
-    };
-
-    for (int i = 0; i < g_copy.numVertices(); ++i) {
-        if (colors[i] == Color::WHITE) {
-            if (has_cycle_util(i)) return false;
-        }
-    }
-    return true;
-}
-
-
-TEMPLATE_TEST_CASE("Feedback Arc Set Algorithm", "[feedback_arc_set]", GraphNList, GraphFList, GraphAMatrix) {
+TEMPLATE_TEST_CASE("Feedback Arc Set Algorithm", "[feedback_arc_set]", GraphNList, GraphFList, GraphAMatrix, GraphHybrid) {
     using IGraphPtr = std::unique_ptr<ImplementedGraph>;
     using GraphType = TestType;
     using FAS = std::vector<std::pair<int, int>>;
@@ -59,7 +33,7 @@ TEMPLATE_TEST_CASE("Feedback Arc Set Algorithm", "[feedback_arc_set]", GraphNLis
         auto result = strategy.execute(g);
         const auto& fas = std::get<FAS>(result);
         INFO("Testing strategy: " << strategy.getName());
-        REQUIRE(is_dag_after_removal(g, fas));
+        REQUIRE(is_acyclic_without(g, fas));
         validation(fas);
     };
 
@@ -0,0 +1,120 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <utility>
+
+import ImplementedGraph;
+import GraphNList;
+import GraphHybrid;
+import GraphFactory;
+import Generator;
+
+namespace {
+    // same multiset of neighbors, the hybrid keeps them sorted
+    bool same_neighbors(std::span<const int> reference, std::span<const int> hybrid) {
+        std::vector<int> sorted(reference.begin(), reference.end());
+        std::ranges::sort(sorted);
+        return std::ranges::equal(sorted, hybrid) && std::ranges::is_sorted(hybrid);
+    }
+
+    void require_same_graph(const GraphNList& reference, const GraphHybrid& hybrid) {
+        REQUIRE(hybrid.numEdges() == reference.numEdges());
+        for (int u = 0; u < reference.numVertices(); ++u) {
+            REQUIRE(same_neighbors(reference.outneighbors(u), hybrid.outneighbors(u)));
+            REQUIRE(same_neighbors(reference.inneighbors(u), hybrid.inneighbors(u)));
+            REQUIRE(hybrid.out_degrees()[u] == reference.out_degree(u));
+            REQUIRE(hybrid.in_degrees()[u] == reference.in_degree(u));
+            for (int v = 0; v < reference.numVertices(); ++v) {
+                REQUIRE(hybrid.has_edge(u, v) == reference.has_edge(u, v));
+            }
+        }
+    }
+}
+
+TEST_CASE("Hybrid representation", "[hybrid]") {
+    constexpr int num_vertices = 200; // hubs need at least 7 targets, inline rows hold 12
+    constexpr int hub = 7;
+
+    SECTION("Every row gets the format of its degree") {
+        GraphHybrid g(num_vertices);
+        for (int i = 0; i < 3; ++i) g.addEdge(0, i + 1);
+        REQUIRE(g.out_format(0) == AdjacencyFormat::Inline);
+        REQUIRE(g.in_format(1) == AdjacencyFormat::Inline);
+
+        for (int i = 0; i < 100; ++i) g.addEdge(hub, i);
+        REQUIRE(g.out_format(hub) == AdjacencyFormat::Bitmap);
+        REQUIRE(g.has_edge(hub, 99));
+        REQUIRE_FALSE(g.has_edge(hub, 100));
+
+        for (int i = 0; i < 20; ++i) g.addEdge(1, i);
+        REQUIRE(g.out_format(1) == AdjacencyFormat::Bitmap);
+        for (int i = 0; i < 14; ++i) g.removeEdge(1, i);
+        REQUIRE(g.out_format(1) == AdjacencyFormat::Inline);
+        REQUIRE(std::ranges::equal(g.outneighbors(1), std::vector<int>{14, 15, 16, 17, 18, 19}));
+
+        const GraphHybrid large(GraphNList(100000));
+        REQUIRE(large.out_format(0) == AdjacencyFormat::Inline);
+    }
+
+    SECTION("Sorted segments between inline rows and hubs") {
+        GraphHybrid g(10000);
+        for (int i = 0; i < 40; ++i) g.addEdge(5, 100 * i);
+        REQUIRE(g.out_format(5) == AdjacencyFormat::Sorted);
+        REQUIRE(g.has_edge(5, 3900));
+        REQUIRE_FALSE(g.has_edge(5, 3901));
+        REQUIRE(g.in_format(100) == AdjacencyFormat::Inline);
+    }
+
+    SECTION("Parallel edges keep their multiplicity") {
+        GraphHybrid g(num_vertices);
+        for (int i = 0; i < 50; ++i) {
+            g.addEdge(hub, i);
+            g.addEdge(hub, 3);
+        }
+        g.removeEdge(hub, 3);
+        REQUIRE(g.has_edge(hub, 3));
+        REQUIRE(g.out_degree(hub) == 99);
+        REQUIRE(std::ranges::count(g.outneighbors(hub), 3) == 50);
+        g.removeEdge(hub, 42);
+        REQUIRE_FALSE(g.has_edge(hub, 42));
+        g.removeEdge(hub, 42); // not an edge any more
+        REQUIRE(g.numEdges() == 98);
+    }
+
+    SECTION("Mutations and conversions match the adjacency list") {
+        std::mt19937 gen(std::random_device{}());
+        std::uniform_int_distribution<> vertex_dist(0, num_vertices - 1);
+        std::uniform_int_distribution<> hub_dist(0, 4);
+
+        GraphNList reference(num_vertices);
+        GraphHybrid hybrid(num_vertices);
+        std::vector<std::pair<int, int>> edges;
+        for (int i = 0; i < 6000; ++i) {
+            // skewed: a few vertices get most of the edges
+            const int u = i % 3 == 0 ? hub_dist(gen) : vertex_dist(gen);
+            const int v = i % 5 == 0 ? hub_dist(gen) : vertex_dist(gen);
+            reference.addEdge(u, v);
+            hybrid.addEdge(u, v);
+            edges.emplace_back(u, v);
+        }
+        std::ranges::shuffle(edges, gen);
+        for (size_t i = 0; i < edges.size() * 2 / 3; ++i) {
+            reference.removeEdge(edges[i].first, edges[i].second);
+            hybrid.removeEdge(edges[i].first, edges[i].second);
+        }
+        require_same_graph(reference, hybrid);
+        require_same_graph(reference, GraphHybrid(reference));
+        require_same_graph(reference.getTranspose(), hybrid.getTranspose());
+        require_same_graph(reference, GraphHybrid(GraphNList(hybrid)));
+
+        auto implemented = GraphFactory<ImplementedGraph>::createGraph<GraphNList>(num_vertices);
+        for (const auto& [u, v] : generate_erdos_renyi_edges(num_vertices, 500)) {
+            implemented->addEdge(u, v);
+        }
+        const auto converted = ImplementedGraph(GraphHybrid(*implemented));
+        for (int u = 0; u < num_vertices; ++u) {
+            REQUIRE(same_neighbors(implemented->outneighbors(u), converted.outneighbors(u)));
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <utility>
+
+import ImplementedGraph;
+import GraphNList;
+import GraphAMatrix;
+import GraphFactory;
+import Generator;
+import MemoryResources;
+
+namespace {
+    using GraphNList16 = BasicGraphNList<std::int16_t, std::int16_t>;
+    using GraphNList64 = BasicGraphNList<std::int64_t, std::int64_t>;
+
+    // adjacency kept as plain vectors, the lists of the slab have to match them element by element
+    template <typename VertexId>
+    struct ReferenceLists {
+        std::vector<std::vector<VertexId>> out, in;
+        explicit ReferenceLists(int num_vertices) : out(num_vertices), in(num_vertices) {}
+
+        void add(VertexId u, VertexId v) {
+            out[u].push_back(v);
+            in[v].push_back(u);
+        }
+
+        void remove(VertexId u, VertexId v) {
+            if (auto it = std::ranges::find(out[u], v); it != out[u].end()) {
+                out[u].erase(it);
+                in[v].erase(std::ranges::find(in[v], u));
+            }
+        }
+    };
+
+    template <typename Graph, typename VertexId>
+    void require_same_lists(const Graph& g, const ReferenceLists<VertexId>& reference) {
+        for (VertexId u = 0; u < g.numVertices(); ++u) {
+            REQUIRE(std::ranges::equal(g.outneighbors(u), reference.out[u]));
+            REQUIRE(std::ranges::equal(g.inneighbors(u), reference.in[u]));
+            REQUIRE(g.out_degrees()[u] == static_cast<typename Graph::edge_offset_type>(reference.out[u].size()));
+            REQUIRE(g.in_degrees()[u] == static_cast<typename Graph::edge_offset_type>(reference.in[u].size()));
+        }
+    }
+}
+
+TEMPLATE_TEST_CASE("Slab-backed neighbor lists", "[nlist]", GraphNList16, GraphNList, GraphNList64) {
+    using Graph = TestType;
+    using VertexId = typename Graph::vertex_type;
+    constexpr int num_vertices = 300;
+
+    SECTION("Lists grow from inline rows through the size classes and keep their order") {
+        Graph g(num_vertices);
+        ReferenceLists<VertexId> reference(num_vertices);
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> vertex(0, num_vertices - 1);
+        // vertex 0 is a hub, every other vertex stays small
+        for (int i = 0; i < 2000; ++i) {
+            const auto u = static_cast<VertexId>(i % 3 == 0 ? 0 : vertex(rng));
+            const auto v = static_cast<VertexId>(vertex(rng));
+            g.addEdge(u, v);
+            reference.add(u, v);
+        }
+        REQUIRE(g.numEdges() == 2000);
+        require_same_lists(g, reference);
+
+        for (int i = 0; i < 1500; ++i) {
+            const auto u = static_cast<VertexId>(i % 2 == 0 ? 0 : vertex(rng));
+            const auto v = static_cast<VertexId>(vertex(rng));
+            g.removeEdge(u, v);
+            reference.remove(u, v);
+        }
+        // freed chunks are reused by the lists that grow after the removals
+        for (int i = 0; i < 1000; ++i) {
+            const auto u = static_cast<VertexId>(vertex(rng));
+            const auto v = static_cast<VertexId>(i % 4 == 0 ? 0 : vertex(rng));
+            g.addEdge(u, v);
+            reference.add(u, v);
+        }
+        require_same_lists(g, reference);
+        for (VertexId u = 0; u < num_vertices; ++u) {
+            for (VertexId v : reference.out[u]) REQUIRE(g.has_edge(u, v));
+        }
+    }
+
+    SECTION("Copies, transposes and conversions") {
+        Graph g(num_vertices);
+        ReferenceLists<VertexId> reference(num_vertices);
+        for (const auto& [u, v] : generate_erdos_renyi_edges(num_vertices, 3000)) {
+            g.addEdge(static_cast<VertexId>(u), static_cast<VertexId>(v));
+            reference.add(static_cast<VertexId>(u), static_cast<VertexId>(v));
+        }
+        const Graph copy(g);
+        g.addEdge(1, 2);
+        require_same_lists(copy, reference);
+
+        const Graph transposed = copy.getTranspose();
+        for (VertexId u = 0; u < num_vertices; ++u) {
+            REQUIRE(std::ranges::equal(transposed.outneighbors(u), reference.in[u]));
+        }
+
+        const Graph converted{GraphAMatrix(copy)};
+        REQUIRE(converted.numEdges() == copy.numEdges());
+        for (VertexId u = 0; u < num_vertices; ++u) {
+            REQUIRE(std::ranges::is_permutation(converted.outneighbors(u), reference.out[u]));
+            REQUIRE(std::ranges::is_permutation(converted.inneighbors(u), reference.in[u]));
+        }
+    }
+
+    SECTION("A copy is a few bulk allocations, not one per vertex") {
+        CountingResource counting;
+        Graph g(num_vertices, &counting);
+        for (const auto& [u, v] : generate_erdos_renyi_edges(num_vertices, 3000)) {
+            g.addEdge(static_cast<VertexId>(u), static_cast<VertexId>(v));
+        }
+        // the slabs grow geometrically, ingestion does not allocate per vertex either
+        REQUIRE(counting.allocations() < 100);
+
+        counting.reset_peak();
+        const Graph copy(g);
+        REQUIRE(counting.allocations() <= 6);
+        REQUIRE(copy.get_memory_resource() == &counting);
+
+        // removing and adding back edges stays within the chunks the lists already have
+        counting.reset_peak();
+        for (VertexId u = 0; u < num_vertices; ++u) {
+            const std::vector<VertexId> neighbors(g.outneighbors(u).begin(), g.outneighbors(u).end());
+            for (VertexId v : neighbors) g.removeEdge(u, v);
+            for (VertexId v : neighbors) g.addEdge(u, v);
+        }
+        REQUIRE(counting.allocations() == 0);
+        REQUIRE(g.numEdges() == copy.numEdges());
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+// true iff removing the edges of fas from graph leaves no cycle, fas being a feedback arc set of graph
+template <typename Graph>
+bool is_acyclic_without(const Graph& graph, const std::vector<std::pair<int, int>>& fas) {
+    auto g_copy = graph;
+    for (const auto& [u, v] : fas) {
+        g_copy.removeEdge(u, v);
+    }
+    // Kahn's algorithm visits every vertex iff there is no cycle
+    const int num_vertices = g_copy.numVertices();
+    std::vector<int> in_degree(num_vertices);
+    std::vector<int> ready;
+    for (int i = 0; i < num_vertices; ++i) {
+        in_degree[i] = g_copy.in_degree(i);
+        if (in_degree[i] == 0) ready.push_back(i);
+    }
+    int visited = 0;
+    while (!ready.empty()) {
+        const int u = ready.back();
+        ready.pop_back();
+        ++visited;
+        for (int v : g_copy.outneighbors(u)) {
+            if (--in_degree[v] == 0) ready.push_back(v);
+        }
+    }
+    return visited == num_vertices;
+}
@@ -0,0 +1,123 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <variant>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <random>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+import ImplementedGraph;
+import GraphNList;
+import GraphFList;
+import GraphAMatrix;
+import GraphFactory;
+import GraphConcepts;
+import GraphAlgo;
+import AlgorithmResult;
+import Generator;
+
+TEMPLATE_TEST_CASE("Narrow index types give the same results", "[index_types]", ImplementedGraph16, ImplementedGraph32, ImplementedGraph32E64) {
+    using NarrowGraph = TestType;
+    using vertex_type = typename NarrowGraph::vertex_type;
+    using NarrowProcessor = GraphProcessor<NarrowGraph>;
+    using WideProcessor = GraphProcessor<ImplementedGraph>;
+
+    SECTION("Every representation stores the narrow type") {
+        auto g = GraphFactory<NarrowGraph>::createGraph(3);
+        g->addEdge(0, 1);
+        g->addEdge(1, 2);
+        STATIC_REQUIRE(std::is_same_v<decltype(g->outneighbors(0)), std::span<const vertex_type>>);
+        REQUIRE(g->numEdges() == 2);
+        REQUIRE(g->outneighbors(1)[0] == 2);
+        g->template convertTo<BasicGraphFList<vertex_type, typename NarrowGraph::edge_offset_type>>();
+        REQUIRE(g->numEdges() == 2);
+        REQUIRE(g->inneighbors(2)[0] == 1);
+        g->template convertTo<BasicGraphAMatrix<vertex_type, typename NarrowGraph::edge_offset_type>>();
+        REQUIRE(g->out_degree(0) == 1);
+        REQUIRE(g->in_degree(0) == 0);
+    }
+
+    SECTION("Randomized graph checks against the int instantiation") {
+        constexpr int num_tests = 10;
+        constexpr int num_vertices = 12;
+
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<> edge_dist(6, 100);
+
+        for (int i = 0; i < num_tests; ++i) {
+            auto narrow = GraphFactory<NarrowGraph>::createGraph(num_vertices);
+            auto wide = GraphFactory<ImplementedGraph>::createGraph(num_vertices);
+            for (const auto& [u, v] : generate_erdos_renyi_edges(num_vertices, edge_dist(gen))) {
+                narrow->addEdge(static_cast<vertex_type>(u), static_cast<vertex_type>(v));
+                wide->addEdge(u, v);
+            }
+
+            REQUIRE(std::get<std::vector<int>>(typename NarrowProcessor::SourceVertexStrategy().execute(*narrow))
+                 == std::get<std::vector<int>>(typename WideProcessor::SourceVertexStrategy().execute(*wide)));
+            REQUIRE(std::get<int>(typename NarrowProcessor::AsyncDiameterStrategy().execute(*narrow))
+                 == std::get<int>(typename WideProcessor::AsyncDiameterStrategy().execute(*wide)));
+            REQUIRE(std::get<std::vector<std::pair<int, int>>>(typename NarrowProcessor::FeedbackArcSetDfsStrategy().execute(*narrow))
+                 == std::get<std::vector<std::pair<int, int>>>(typename WideProcessor::FeedbackArcSetDfsStrategy().execute(*wide)));
+            REQUIRE(std::get<int>(typename NarrowProcessor::TarjanUniversalSourceFinderStrategy().execute(*narrow))
+                 == std::get<int>(typename WideProcessor::TarjanUniversalSourceFinderStrategy().execute(*wide)));
+        }
+    }
+}
+
+TEST_CASE("Narrowest graph factory", "[index_types]") {
+    SECTION("index_types_fit") {
+        REQUIRE(index_types_fit<std::uint16_t, std::uint32_t>(65535, 10));
+        REQUIRE_FALSE(index_types_fit<std::uint16_t, std::uint32_t>(65536, 10));
+        REQUIRE_FALSE(index_types_fit<std::uint32_t, std::uint32_t>(10, 1ull << 32));
+        REQUIRE(index_types_fit<std::uint64_t, std::uint64_t>(1ull << 40, 1ull << 40));
+    }
+
+    SECTION("Small graphs get 16 bit vertex ids") {
+        AnyImplementedGraph g = NarrowestGraphFactory::createGraph(100, 5000);
+        REQUIRE(std::holds_alternative<std::unique_ptr<ImplementedGraph16>>(g));
+        REQUIRE(std::get<std::unique_ptr<ImplementedGraph16>>(g)->numVertices() == 100);
+    }
+
+    SECTION("More than 65535 vertices need 32 bit vertex ids") {
+        AnyImplementedGraph g = NarrowestGraphFactory::createGraph(70000, 10);
+        REQUIRE(std::holds_alternative<std::unique_ptr<ImplementedGraph32>>(g));
+    }
+
+    SECTION("More than 2^32 edges need 64 bit offsets, the vertex ids stay 32 bit") {
+        AnyImplementedGraph g = NarrowestGraphFactory::createGraph(10, (1ull << 32) + 1);
+        REQUIRE(std::holds_alternative<std::unique_ptr<ImplementedGraph32E64>>(g));
+        AnyImplementedGraph many_vertices = NarrowestGraphFactory::createGraph(70000, (1ull << 32) + 1);
+        REQUIRE(std::holds_alternative<std::unique_ptr<ImplementedGraph32E64>>(many_vertices));
+    }
+
+    SECTION("Vertex counts the int based algorithms cannot index are rejected") {
+        const std::uint64_t too_many = static_cast<std::uint64_t>(std::numeric_limits<int>::max()) + 1;
+        REQUIRE_THROWS_AS(NarrowestGraphFactory::createGraph(too_many, 0), std::length_error);
+        REQUIRE_THROWS_AS(NarrowestGraphFactory::createGraph(std::uint64_t{1} << 32, 10), std::length_error);
+        REQUIRE_THROWS_AS(NarrowestGraphFactory::createWideGraph(too_many), std::length_error);
+    }
+
+    SECTION("Graphs read into the wide graph are narrowed once") {
+        auto wide = NarrowestGraphFactory::createWideGraph(300);
+        const std::vector<std::pair<std::uint32_t, std::uint32_t>> edges = {{0, 299}, {0, 5}, {0, 17}, {299, 0}, {42, 42}};
+        for (const auto& [u, v] : edges) wide->addEdge(u, v);
+        AnyImplementedGraph g = NarrowestGraphFactory::narrow(std::move(wide));
+        REQUIRE(std::holds_alternative<std::unique_ptr<ImplementedGraph16>>(g));
+        const auto& narrow = *std::get<std::unique_ptr<ImplementedGraph16>>(g);
+        REQUIRE(narrow.numVertices() == 300);
+        REQUIRE(narrow.numEdges() == edges.size());
+        REQUIRE(std::ranges::equal(narrow.outneighbors(0), std::vector<std::uint16_t>{299, 5, 17}));
+        REQUIRE(narrow.has_edge(299, 0));
+        REQUIRE(narrow.has_edge(42, 42));
+
+        AnyImplementedGraph many_vertices = NarrowestGraphFactory::narrow(NarrowestGraphFactory::createWideGraph(70000));
+        REQUIRE(std::holds_alternative<std::unique_ptr<ImplementedGraph32>>(many_vertices));
+    }
+}
@@ -0,0 +1,115 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <variant>
+#include <vector>
+
+import ImplementedGraph;
+import GraphNList;
+import GraphFList;
+import GraphAMatrix;
+import GraphHybrid;
+import GraphFactory;
+import GraphAlgo;
+import AlgorithmResult;
+import MemoryResources;
+
+// restores new/delete as the scratch upstream when a test ends
+struct ScratchUpstreamGuard {
+    explicit ScratchUpstreamGuard(std::pmr::memory_resource* resource) { set_scratch_upstream(resource); }
+    ~ScratchUpstreamGuard() { set_scratch_upstream(nullptr); }
+};
+
+TEMPLATE_TEST_CASE("Graph storage on a memory resource", "[memory]", GraphNList, GraphFList, GraphAMatrix, GraphHybrid) {
+    using GraphType = TestType;
+    CountingResource counting;
+
+    SECTION("The graph allocates from the given resource") {
+        auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(40, &counting);
+        for (int i = 0; i < 40; ++i) {
+            g->addEdge(i, (i + 1) % 40);
+        }
+        REQUIRE(g->get_memory_resource() == &counting);
+        REQUIRE(counting.bytes_in_use() > 0);
+        REQUIRE(g->numEdges() == 40);
+        REQUIRE(g->has_edge(39, 0));
+    }
+
+    SECTION("Copies, transposes and conversions stay on the resource") {
+        auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(5, &counting);
+        g->addEdge(0, 1);
+        g->addEdge(1, 2);
+        const ImplementedGraph copy(*g);
+        REQUIRE(copy.get_memory_resource() == &counting);
+        REQUIRE(g->getTranspose().get_memory_resource() == &counting);
+        copy.convertTo<GraphNList>();
+        copy.convertTo<GraphHybrid>();
+        REQUIRE(copy.get_memory_resource() == &counting);
+        REQUIRE(copy.numEdges() == 2);
+    }
+
+    SECTION("Everything is returned to the resource") {
+        {
+            auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(20, &counting);
+            g->addEdge(3, 4);
+            g->template convertTo<GraphFList>();
+        }
+        REQUIRE(counting.bytes_in_use() == 0);
+    }
+}
+
+TEMPLATE_TEST_CASE("Scratch memory of a run", "[memory]", GraphNList, GraphFList, GraphAMatrix, GraphHybrid) {
+    using GraphType = TestType;
+    using Processor = GraphProcessor<ImplementedGraph>;
+    CountingResource counting;
+    ScratchUpstreamGuard guard(&counting);
+
+    auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(6);
+    for (int i = 0; i < 6; ++i) {
+        g->addEdge(i, (i + 1) % 6);
+    }
+    g->addEdge(2, 0);
+
+    SECTION("Arenas take their blocks from the scratch upstream and free them after the run") {
+        REQUIRE(std::get<int>(Processor::SequentialDiameterStrategy().execute(*g)) == 5);
+        REQUIRE(std::get<int>(Processor::ParallelDiameterStrategy().execute(*g)) == 5);
+        REQUIRE(std::get<int>(Processor::KosarajuUniversalSourceFinderStrategy().execute(*g)) == 0);
+        REQUIRE(std::get<int>(Processor::PathBasedUniversalSourceFinderStrategy().execute(*g)) == 0);
+        REQUIRE(counting.allocations() > 0);
+        REQUIRE(counting.bytes_in_use() == 0);
+    }
+
+    SECTION("Repeated cycle searches reuse their buffers") {
+        const auto removed = std::get<std::vector<std::pair<int, int>>>(Processor::FeedbackArcSetRemoveCyclesStrategy().execute(*g));
+        REQUIRE(!removed.empty());
+        const auto discarded = std::get<std::vector<std::pair<int, int>>>(Processor::FeedbackArcSetInsertEdgesStrategy().execute(*g));
+        REQUIRE(!discarded.empty());
+        REQUIRE(counting.bytes_in_use() == 0);
+    }
+}
+
+TEST_CASE("Huge page resource", "[memory]") {
+    HugePageResource huge_pages(HugePageResource::huge_page_size);
+
+    SECTION("Small blocks go upstream, large ones are mapped") {
+        std::pmr::vector<int> small(16, 1, &huge_pages);
+        REQUIRE(huge_pages.mapped_bytes() == 0);
+        {
+            std::pmr::vector<int> large(HugePageResource::huge_page_size / sizeof(int) + 1, 7, &huge_pages);
+            REQUIRE(large.back() == 7);
+#ifdef __linux__
+            REQUIRE(huge_pages.mapped_bytes() == 2 * HugePageResource::huge_page_size);
+            REQUIRE(reinterpret_cast<std::uintptr_t>(large.data()) % HugePageResource::huge_page_size == 0);
+#endif
+        }
+        REQUIRE(huge_pages.mapped_bytes() == 0);
+    }
+
+    SECTION("Graph storage") {
+        GraphFList source(GraphNList(3), &huge_pages);
+        const ImplementedGraph g(GraphAMatrix(source, &huge_pages));
+        REQUIRE(g.get_memory_resource() == &huge_pages);
+        REQUIRE(g.numVertices() == 3);
+    }
+}
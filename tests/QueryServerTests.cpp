@@ -0,0 +1,82 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+
+import ImplementedGraph;
+import GraphNList;
+import GraphFList;
+import GraphAMatrix;
+import GraphFactory;
+import QueryServer;
+
+// response payload by sequence number, responses of concurrent queries arrive in any order
+std::map<size_t, std::string> run_queries(std::unique_ptr<ImplementedGraph> g, const std::string& requests) {
+    std::istringstream in(requests);
+    std::ostringstream out;
+    {
+        GraphQueryServer<ImplementedGraph> server(std::move(g), out);
+        server.serve(in);
+    }
+    std::map<size_t, std::string> responses;
+    std::istringstream lines(out.str());
+    size_t seq;
+    std::string rest;
+    while (lines >> seq && std::getline(lines, rest)) {
+        responses[seq] = rest.substr(1);
+    }
+    return responses;
+}
+
+TEMPLATE_TEST_CASE("Query server", "[server]", GraphNList, GraphFList, GraphAMatrix) {
+    using GraphType = TestType;
+    auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(4);
+    g->addEdge(0, 1);
+    g->addEdge(1, 2);
+    g->addEdge(2, 3);
+
+    SECTION("Read queries") {
+        auto responses = run_queries(std::move(g), "solve 1\nsolve 2\nsolve 3\nsolve 4\nstats\nscheduler\n");
+        REQUIRE(responses.size() == 6);
+        REQUIRE(responses[1] == "ok 1 0");
+        REQUIRE(responses[2] == "ok -1");
+        REQUIRE(responses[3] == "ok 0");
+        REQUIRE(responses[4] == "ok 0");
+        REQUIRE(responses[5].starts_with("ok vertices 4 edges 3"));
+        REQUIRE(responses[6].starts_with("ok workers "));
+    }
+
+    SECTION("Queries observe the mutations issued before them") {
+        auto responses = run_queries(std::move(g), "solve 2\nadd 3 0\nsolve 2\nsolve 1\nremove 3 0\nsolve 2\nconvert amatrix\nstats\n");
+        REQUIRE(responses[1] == "ok -1");
+        REQUIRE(responses[2] == "ok");
+        REQUIRE(responses[3] == "ok 3");
+        REQUIRE(responses[4] == "ok 0");
+        REQUIRE(responses[5] == "ok");
+        REQUIRE(responses[6] == "ok -1");
+        REQUIRE(responses[7] == "ok");
+        REQUIRE(responses[8].starts_with("ok vertices 4 edges 3 implementation amatrix vertex_bits 32 version 3"));
+    }
+
+    SECTION("Consecutive edge updates are published as one version") {
+        auto responses = run_queries(std::move(g), "add 3 0\nadd 3 1\nremove 0 1\nstats\nsolve 4\nadd 0 5\nstats\n");
+        REQUIRE(responses[1] == "ok");
+        REQUIRE(responses[3] == "ok");
+        REQUIRE(responses[4].starts_with("ok vertices 4 edges 4 implementation"));
+        REQUIRE(responses[4].find(" version 1 ") != std::string::npos);
+        REQUIRE(responses[5] == "ok 1");
+        REQUIRE(responses[6].starts_with("error"));
+        REQUIRE(responses[7].find(" version 1 ") != std::string::npos);
+    }
+
+    SECTION("Bad requests get an error response") {
+        auto responses = run_queries(std::move(g), "add 0 7\nsolve 9\nconvert tree\nfrobnicate\nquit\nsolve 1\n");
+        REQUIRE(responses.size() == 5);
+        REQUIRE(responses[1].starts_with("error"));
+        REQUIRE(responses[2].starts_with("error"));
+        REQUIRE(responses[3].starts_with("error"));
+        REQUIRE(responses[4].starts_with("error"));
+        REQUIRE(responses[5] == "ok");
+    }
+}
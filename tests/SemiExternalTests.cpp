@@ -0,0 +1,315 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <variant>
+#include <vector>
+
+import ImplementedGraph;
+import GraphNList;
+import GraphFList;
+import GraphAMatrix;
+import GraphHybrid;
+import GraphFactory;
+import GraphAlgo;
+import AlgorithmResult;
+import Generator;
+import Cancellation;
+import CsrFile;
+import SemiExternal;
+
+// a CSR file in the temp directory, removed when the test ends
+struct TempCsrPath {
+    std::string path;
+    explicit TempCsrPath(const std::string& name)
+        : path((std::filesystem::temp_directory_path() / ("mgmcc_test_" + name + ".csr")).string()) {}
+    ~TempCsrPath() {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+    }
+};
+
+// same partition, the component ids may differ
+bool samePartition(const std::vector<std::uint32_t>& a, const std::vector<int>& b) {
+    if (a.size() != b.size()) return false;
+    std::map<std::uint32_t, int> a_to_b;
+    std::map<int, std::uint32_t> b_to_a;
+    for (size_t u = 0; u < a.size(); ++u) {
+        if (a_to_b.try_emplace(a[u], b[u]).first->second != b[u]) return false;
+        if (b_to_a.try_emplace(b[u], a[u]).first->second != a[u]) return false;
+    }
+    return true;
+}
+
+TEMPLATE_TEST_CASE("Semi-external algorithms match the in-memory ones", "[semi-external]", GraphNList, GraphFList, GraphAMatrix, GraphHybrid) {
+    using GraphType = TestType;
+    const TempCsrPath csr("matches_" + std::string(typeid(GraphType).name()));
+    constexpr int vertex_count = 60;
+    auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(vertex_count);
+    for (const auto& [u, v] : generate_erdos_renyi_edges(vertex_count, 90)) {
+        g->addEdge(u, v);
+    }
+    // a cycle through the first ten vertices, so there is a component with more than one vertex
+    for (int i = 0; i < 10; ++i) {
+        g->addEdge(i, (i + 1) % 10);
+    }
+    // small blocks, so every scan takes several reads
+    write_csr_file(csr.path, *g, 64);
+    CsrFile file(csr.path, 64);
+    REQUIRE(file.numVertices() == vertex_count);
+    REQUIRE(file.numEdges() == static_cast<std::uint64_t>(g->numEdges()));
+
+    SECTION("Adjacency") {
+        std::vector<std::vector<int>> out(vertex_count), in(vertex_count);
+        file.scan(Direction::Out, [&](std::uint32_t u, std::span<const std::uint32_t> neighbors) {
+            out[u].assign(neighbors.begin(), neighbors.end());
+        });
+        file.scan(Direction::In, [&](std::uint32_t u, std::span<const std::uint32_t> neighbors) {
+            in[u].assign(neighbors.begin(), neighbors.end());
+        });
+        for (int u = 0; u < vertex_count; ++u) {
+            REQUIRE(out[u].size() == g->outneighbors(u).size());
+            REQUIRE(in[u].size() == g->inneighbors(u).size());
+            for (int v : out[u]) REQUIRE(g->has_edge(u, v));
+            for (int w : in[u]) REQUIRE(g->has_edge(w, u));
+        }
+        REQUIRE(file.io_stats().bytes_read == 2 * file.numEdges() * sizeof(std::uint32_t));
+        REQUIRE(file.io_stats().block_reads > 2);
+        REQUIRE(file.io_stats().scans == 2);
+    }
+
+    SECTION("Sources and in-degrees without reading the adjacency") {
+        const auto [degrees, degree_io] = semi_external_in_degrees(file);
+        for (int u = 0; u < vertex_count; ++u) {
+            REQUIRE(degrees[u] == g->inneighbors(u).size());
+        }
+        const auto sources = semi_external_sources(file);
+        const auto expected = std::get<std::vector<int>>(GraphProcessor<ImplementedGraph>::SourceVertexStrategy().execute(*g));
+        REQUIRE(std::ranges::equal(sources.value, expected));
+        REQUIRE(sources.io.bytes_read == 0);
+        REQUIRE(file.io_stats().bytes_read == 0);
+    }
+
+    SECTION("BFS") {
+        const auto [levels, io] = semi_external_bfs(file, 0);
+        std::vector<int> dist(vertex_count, -1);
+        std::vector<int> queue = {0};
+        dist[0] = 0;
+        for (size_t i = 0; i < queue.size(); ++i) {
+            for (int v : g->outneighbors(queue[i])) {
+                if (dist[v] == -1) {
+                    dist[v] = dist[queue[i]] + 1;
+                    queue.push_back(v);
+                }
+            }
+        }
+        for (int u = 0; u < vertex_count; ++u) {
+            REQUIRE(levels.dist[u] == (dist[u] == -1 ? unreached : static_cast<std::uint32_t>(dist[u])));
+        }
+        REQUIRE(levels.reached == queue.size());
+        REQUIRE(io.bytes_read > 0);
+        REQUIRE(io.bytes_read <= file.numEdges() * sizeof(std::uint32_t));
+        REQUIRE(io.scans == levels.eccentricity + 1);
+        REQUIRE_THROWS_AS(semi_external_bfs(file, vertex_count), std::out_of_range);
+    }
+
+    SECTION("Strongly connected components") {
+        const auto [decomposition, io] = semi_external_scc(file);
+        const auto expected = GraphProcessor<ImplementedGraph>::strongly_connected_components(*g);
+        REQUIRE(decomposition.scc_count == static_cast<std::uint32_t>(expected.scc_count));
+        REQUIRE(samePartition(decomposition.scc_map, expected.scc_map));
+        REQUIRE(decomposition.scc_map[0] == decomposition.scc_map[9]);
+        REQUIRE(io.bytes_read > 0);
+        REQUIRE(semi_external_is_strongly_connected(file).value == (expected.scc_count == 1));
+    }
+}
+
+TEST_CASE("Semi-external strong connectivity", "[semi-external]") {
+    const TempCsrPath csr("strong");
+    constexpr int n = 1000;
+    auto cycle = [](auto&& callback) {
+        for (std::uint64_t u = 0; u < n; ++u) callback(u, (u + 1) % n);
+    };
+
+    SECTION("A cycle is one component") {
+        write_csr_file(csr.path, n, cycle, 256);
+        CsrFile file(csr.path, 256);
+        REQUIRE(semi_external_is_strongly_connected(file).value);
+        const auto scc = semi_external_scc(file);
+        REQUIRE(scc.value.scc_count == 1);
+        const auto bfs = semi_external_bfs(file, 0, Direction::In);
+        REQUIRE(bfs.value.eccentricity == n - 1);
+        REQUIRE(bfs.value.dist[n - 1] == 1);
+    }
+
+    SECTION("A path is n components") {
+        write_csr_file(csr.path, n, [](auto&& callback) {
+            for (std::uint64_t u = 0; u + 1 < n; ++u) callback(u, u + 1);
+        }, 256);
+        CsrFile file(csr.path, 256);
+        REQUIRE_FALSE(semi_external_is_strongly_connected(file).value);
+        REQUIRE(semi_external_scc(file).value.scc_count == n);
+        REQUIRE(semi_external_sources(file).value == std::vector<std::uint32_t>{0});
+    }
+
+    SECTION("A long path is trimmed one layer at a time without rescanning all vertices") {
+        // one layer per vertex, quadratic if every layer looked at every vertex
+        constexpr std::uint64_t length = 50000;
+        write_csr_file(csr.path, length, [](auto&& callback) {
+            for (std::uint64_t u = 0; u + 1 < length; ++u) callback(u, u + 1);
+        });
+        CsrFile file(csr.path);
+        const auto [decomposition, io] = semi_external_scc(file);
+        REQUIRE(decomposition.scc_count == length);
+        // both ends are trimmed together, an out and an in scan per layer
+        REQUIRE(io.scans == length);
+    }
+
+    SECTION("Cancellation") {
+        write_csr_file(csr.path, n, cycle);
+        CsrFile file(csr.path);
+        std::stop_source stop;
+        stop.request_stop();
+        const CancellationToken token(stop.get_token());
+        REQUIRE_THROWS_AS(semi_external_scc(file, token), OperationCancelled);
+        REQUIRE_THROWS_AS(semi_external_bfs(file, 0, Direction::Out, token), OperationCancelled);
+    }
+}
+
+TEST_CASE("CSR files", "[semi-external]") {
+    const TempCsrPath csr("files");
+
+    SECTION("Empty graph") {
+        write_csr_file(csr.path, 0, [](auto&&) {});
+        CsrFile file(csr.path);
+        REQUIRE(file.numVertices() == 0);
+        REQUIRE(semi_external_scc(file).value.scc_count == 0);
+        REQUIRE(semi_external_is_strongly_connected(file).value);
+    }
+
+    SECTION("Invalid edges and files") {
+        REQUIRE_THROWS_AS(write_csr_file(csr.path, 3, [](auto&& callback) { callback(0, 3); }), std::out_of_range);
+        {
+            std::ofstream text(csr.path);
+            text << "3\n0 1\n";
+        }
+        REQUIRE_FALSE(is_csr_file(csr.path));
+        REQUIRE_THROWS_AS(CsrFile(csr.path), std::runtime_error);
+    }
+
+    SECTION("Corrupt files are rejected") {
+        write_csr_file(csr.path, 4, [](auto&& callback) {
+            callback(0, 1);
+            callback(1, 2);
+            callback(2, 0);
+        });
+        const auto size = std::filesystem::file_size(csr.path);
+        auto patch = [&](std::streamoff position, std::uint64_t value) {
+            std::fstream file(csr.path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(position);
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+        // header: magic, version, V, E, then the V + 1 out offsets
+        constexpr std::streamoff edges_field = 24;
+        constexpr std::streamoff out_offsets = 32;
+        REQUIRE_NOTHROW(CsrFile(csr.path));
+
+        SECTION("Edge count overflowing the layout") {
+            patch(edges_field, std::numeric_limits<std::uint64_t>::max() / 2);
+            REQUIRE_THROWS_AS(CsrFile(csr.path), std::runtime_error);
+        }
+        SECTION("Edge count not matching the file size") {
+            patch(edges_field, 4);
+            REQUIRE_THROWS_AS(CsrFile(csr.path), std::runtime_error);
+        }
+        SECTION("Truncated file") {
+            std::filesystem::resize_file(csr.path, size - sizeof(std::uint32_t));
+            REQUIRE_THROWS_AS(CsrFile(csr.path), std::runtime_error);
+        }
+        SECTION("Decreasing offsets") {
+            // out offsets 0 1 2 3 3 become 0 3 2 3 3
+            patch(out_offsets + 8, 3);
+            REQUIRE_THROWS_AS(CsrFile(csr.path), std::runtime_error);
+        }
+        SECTION("Offsets beyond the edge count") {
+            patch(out_offsets + 16, 7);
+            REQUIRE_THROWS_AS(CsrFile(csr.path), std::runtime_error);
+        }
+    }
+
+    SECTION("The edge source is read twice for any block size") {
+        constexpr std::uint64_t n = 5000;
+        int passes = 0;
+        write_csr_file(csr.path, n, [&](auto&& callback) {
+            ++passes;
+            for (std::uint64_t u = 0; u < n; ++u) {
+                callback(u, (u * 7 + 1) % n);
+                callback(u, (u * 13 + 5) % n);
+            }
+        }, 64);
+        REQUIRE(passes == 2);
+        CsrFile file(csr.path, 64);
+        REQUIRE(file.numEdges() == 2 * n);
+        file.scan(Direction::Out, [&](std::uint32_t u, std::span<const std::uint32_t> neighbors) {
+            REQUIRE(neighbors.size() == 2);
+            REQUIRE(neighbors[0] == (u * 7 + 1) % n);
+            REQUIRE(neighbors[1] == (u * 13 + 5) % n);
+        });
+        std::uint64_t in_total = 0;
+        file.scan(Direction::In, [&](std::uint32_t v, std::span<const std::uint32_t> neighbors) {
+            for (std::uint32_t u : neighbors) REQUIRE(((u * 7 + 1) % n == v || (u * 13 + 5) % n == v));
+            in_total += neighbors.size();
+        });
+        REQUIRE(in_total == 2 * n);
+        // the bucket files are gone
+        const auto directory = std::filesystem::path(csr.path).parent_path();
+        const auto name = std::filesystem::path(csr.path).filename().string();
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            const auto other = entry.path().filename().string();
+            REQUIRE((other == name || !other.starts_with(name)));
+        }
+    }
+
+    SECTION("Read errors of the reader thread reach the scan") {
+        constexpr std::uint64_t n = 2000;
+        write_csr_file(csr.path, n, [](auto&& callback) {
+            for (std::uint64_t u = 0; u < n; ++u) callback(u, (u + 1) % n);
+        });
+        CsrFile file(csr.path, 256);
+        // the first block of a scan is read by the caller, the last ones by the reader thread
+        std::filesystem::resize_file(csr.path, std::filesystem::file_size(csr.path) - 1024);
+        std::uint64_t visited = 0;
+        REQUIRE_THROWS_AS(file.scan(Direction::In, [&](std::uint32_t, std::span<const std::uint32_t>) { ++visited; }),
+                          std::runtime_error);
+        REQUIRE(visited > 0);
+        // the reader survives for the next scans
+        visited = 0;
+        file.scan(Direction::Out, [&](std::uint32_t, std::span<const std::uint32_t>) { ++visited; });
+        REQUIRE(visited == n);
+    }
+
+    SECTION("Text graphs are converted") {
+        const std::string text_path = csr.path + ".txt";
+        {
+            std::ofstream text(text_path);
+            text << "4\n0 1\n1 2\n2 0\n2 3\n";
+        }
+        convert_text_to_csr(text_path, csr.path, 4);
+        std::filesystem::remove(text_path);
+        REQUIRE(is_csr_file(csr.path));
+        CsrFile file(csr.path);
+        REQUIRE(file.numEdges() == 4);
+        REQUIRE(file.degree(Direction::Out, 2) == 2);
+        REQUIRE(file.degree(Direction::In, 3) == 1);
+        REQUIRE(semi_external_scc(file).value.scc_count == 2);
+    }
+}
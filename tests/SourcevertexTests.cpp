@@ -10,6 +10,7 @@ import ImplementedGraph;
 import GraphNList;
 import GraphFList;
 import GraphAMatrix;
+import GraphHybrid;
 import GraphFactory;
 import GraphAlgo;
 import AlgorithmResult;
@@ -43,7 +44,7 @@ bool verify_sources(const GraphNList& graph, const std::vector<int>& reported_so
 }
 
 
-TEMPLATE_TEST_CASE("Source Vertexes Algorithm", "[source_vertexes]", GraphNList, GraphFList, GraphAMatrix) {
+TEMPLATE_TEST_CASE("Source Vertexes Algorithm", "[source_vertexes]", GraphNList, GraphFList, GraphAMatrix, GraphHybrid) {
     using IGraphPtr = std::unique_ptr<ImplementedGraph>;
     using GraphType = TestType;
     GraphProcessor<ImplementedGraph>::SourceVertexStrategy strategy;
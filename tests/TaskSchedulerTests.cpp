@@ -0,0 +1,141 @@
+#include <catch2/catch_test_macros.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+import TaskScheduler;
+
+TEST_CASE("Task scheduler", "[scheduler]") {
+    TaskScheduler scheduler(SchedulerConfig{.num_workers = 4, .cpu_affinity = {}, .chunk_size = 0});
+
+    SECTION("parallel_for visits every index exactly once") {
+        for (size_t chunk_size : {0, 1, 7, 1000}) {
+            std::vector<std::atomic<int>> visits(1000);
+            parallel_for(0, 1000, [&](int i) { visits[i].fetch_add(1); }, chunk_size, scheduler);
+            for (const auto& count : visits) {
+                REQUIRE(count.load() == 1);
+            }
+        }
+    }
+
+    SECTION("Empty and reversed ranges do nothing") {
+        int calls = 0;
+        parallel_for(5, 5, [&](int) { ++calls; }, 0, scheduler);
+        parallel_for(5, 2, [&](int) { ++calls; }, 0, scheduler);
+        REQUIRE(calls == 0);
+        REQUIRE(parallel_transform_reduce(3, 3, 42, std::plus<>(), [](int i) { return i; }, 0, scheduler) == 42);
+    }
+
+    SECTION("parallel_transform_reduce matches the sequential result") {
+        std::vector<std::uint64_t> values(10007);
+        std::iota(values.begin(), values.end(), 1);
+        const std::uint64_t expected = std::accumulate(values.begin(), values.end(), std::uint64_t{0});
+        for (size_t chunk_size : {0, 1, 64}) {
+            const std::uint64_t sum = parallel_transform_reduce(size_t{0}, values.size(), std::uint64_t{0}, std::plus<>(),
+                                                                [&](size_t i) { return values[i]; }, chunk_size, scheduler);
+            REQUIRE(sum == expected);
+        }
+    }
+
+    SECTION("Nested parallel loops do not deadlock") {
+        std::atomic<int> total = 0;
+        parallel_for(0, 16, [&](int) {
+            parallel_for(0, 100, [&](int) { total.fetch_add(1); }, 1, scheduler);
+        }, 1, scheduler);
+        REQUIRE(total.load() == 1600);
+    }
+
+    SECTION("Task groups and utilization counters") {
+        scheduler.reset_stats();
+        std::atomic<int> done = 0;
+        {
+            TaskGroup group(scheduler);
+            for (int i = 0; i < 50; ++i) {
+                group.run([&] { done.fetch_add(1); });
+            }
+            group.wait();
+            REQUIRE(done.load() == 50);
+        }
+        const SchedulerStats stats = scheduler.stats();
+        REQUIRE(stats.workers.size() == 4);
+        REQUIRE(stats.tasks_executed <= 50);
+        REQUIRE(stats.utilization >= 0.0);
+        REQUIRE(stats.utilization <= 1.0);
+    }
+
+    SECTION("Exceptions of tasks reach the waiting thread") {
+        std::atomic<int> done = 0;
+        TaskGroup group(scheduler);
+        for (int i = 0; i < 20; ++i) {
+            group.run([&, i] {
+                if (i == 7) throw std::runtime_error("task failed");
+                done.fetch_add(1);
+            });
+        }
+        REQUIRE_THROWS_AS(group.wait(), std::runtime_error);
+        REQUIRE(done.load() == 19);
+        group.wait(); // rethrown once
+
+        REQUIRE_THROWS_AS(parallel_for(0, 100, [](int i) {
+            if (i == 42) throw std::bad_alloc();
+        }, 1, scheduler), std::bad_alloc);
+        // the workers survived
+        std::atomic<int> total = 0;
+        parallel_for(0, 100, [&](int) { total.fetch_add(1); }, 1, scheduler);
+        REQUIRE(total.load() == 100);
+    }
+
+    SECTION("Nested tasks are not counted twice") {
+        // one worker runs the outer task and, while it waits, all of its inner tasks
+        TaskScheduler single(SchedulerConfig{.num_workers = 1, .cpu_affinity = {}, .chunk_size = 0});
+        auto spin = [](std::chrono::microseconds duration) {
+            const auto until = std::chrono::steady_clock::now() + duration;
+            while (std::chrono::steady_clock::now() < until) {}
+        };
+        single.reset_stats();
+        std::atomic<bool> finished = false;
+        TaskGroup group(single);
+        group.run([&] {
+            parallel_for(0, 20, [&](int) { spin(std::chrono::microseconds(500)); }, 1, single);
+            finished.store(true);
+        });
+        // not group.wait(), the calling thread must not take tasks itself
+        while (!finished.load()) std::this_thread::yield();
+        group.wait();
+        const SchedulerStats stats = single.stats();
+        REQUIRE(stats.tasks_executed == 21);
+        REQUIRE(stats.utilization > 0.0);
+        REQUIRE(stats.utilization <= 1.0);
+    }
+}
+
+TEST_CASE("Global task scheduler", "[scheduler]") {
+    // concurrent first uses share one scheduler
+    std::atomic<bool> go = false;
+    std::vector<TaskScheduler*> seen(8, nullptr);
+    {
+        std::vector<std::jthread> callers;
+        for (size_t i = 0; i < seen.size(); ++i) {
+            callers.emplace_back([&, i] {
+                while (!go.load()) std::this_thread::yield();
+                seen[i] = &TaskScheduler::global();
+            });
+        }
+        go.store(true);
+    }
+    for (TaskScheduler* scheduler : seen) {
+        REQUIRE(scheduler == &TaskScheduler::global());
+    }
+
+    TaskScheduler::configure_global(SchedulerConfig{.num_workers = 2, .cpu_affinity = {}, .chunk_size = 0});
+    REQUIRE(TaskScheduler::global().num_workers() == 2);
+    std::atomic<int> total = 0;
+    parallel_for(0, 100, [&](int) { total.fetch_add(1); });
+    REQUIRE(total.load() == 100);
+    TaskScheduler::configure_global(SchedulerConfig{});
+}
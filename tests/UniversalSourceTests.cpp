@@ -8,12 +8,13 @@ import ImplementedGraph;
 import GraphNList;
 import GraphFList;
 import GraphAMatrix;
+import GraphHybrid;
 import GraphFactory;
 import GraphAlgo;
 import AlgorithmResult;
 import Generator;
 
-TEMPLATE_TEST_CASE("Universal Source Vertex Calculation", "[universal_source]", GraphNList, GraphFList, GraphAMatrix) {
+TEMPLATE_TEST_CASE("Universal Source Vertex Calculation", "[universal_source]", GraphNList, GraphFList, GraphAMatrix, GraphHybrid) {
     using IGraphPtr = std::unique_ptr<ImplementedGraph>;
     using GraphType = TestType;
 
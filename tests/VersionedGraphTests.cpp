@@ -0,0 +1,203 @@
+#include <catch2/catch_template_test_macros.hpp>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <variant>
+#include <vector>
+
+import ImplementedGraph;
+import GraphNList;
+import GraphFList;
+import GraphAMatrix;
+import GraphFactory;
+import GraphAlgo;
+import AlgorithmResult;
+import VersionedGraph;
+import MemoryResources;
+
+TEMPLATE_TEST_CASE("Versioned graph", "[snapshot]", GraphNList, GraphFList, GraphAMatrix) {
+    using GraphType = TestType;
+    using Processor = GraphProcessor<ImplementedGraph>;
+    auto g = GraphFactory<ImplementedGraph>::createGraph<GraphType>(4);
+    g->addEdge(0, 1);
+    g->addEdge(1, 2);
+    g->addEdge(2, 3);
+    VersionedGraph<ImplementedGraph> graph(std::move(*g));
+
+    SECTION("Snapshots do not see later batches") {
+        const auto before = graph.snapshot();
+        REQUIRE(before.getVersion() == 0);
+
+        EdgeBatch batch;
+        batch.add(3, 0);
+        batch.remove(0, 1);
+        batch.add(0, 1);
+        REQUIRE(graph.apply(batch) == 1);
+
+        const auto after = graph.snapshot();
+        REQUIRE(after.getVersion() == 1);
+        REQUIRE(before->numEdges() == 3);
+        REQUIRE(after->numEdges() == 4);
+        REQUIRE(std::get<int>(Processor::SequentialDiameterStrategy().execute(*before)) == -1);
+        REQUIRE(std::get<int>(Processor::SequentialDiameterStrategy().execute(*after)) == 3);
+    }
+
+    SECTION("A version is freed with its last snapshot") {
+        REQUIRE(graph.retainedVersions() == 1);
+        auto old_snapshot = graph.snapshot();
+        auto copy = old_snapshot;
+        EdgeBatch batch;
+        batch.add(3, 0);
+        graph.apply(batch);
+        REQUIRE(graph.retainedVersions() == 2);
+        old_snapshot = {};
+        REQUIRE(graph.retainedVersions() == 2);
+        copy = {};
+        REQUIRE(graph.retainedVersions() == 1);
+    }
+
+    SECTION("A failed batch publishes nothing") {
+        EdgeBatch batch;
+        batch.add(3, 0);
+        batch.add(0, 9);
+        REQUIRE_THROWS_AS(graph.apply(batch), std::out_of_range);
+        REQUIRE(graph.snapshot().getVersion() == 0);
+        REQUIRE(graph.snapshot()->numEdges() == 3);
+        REQUIRE(graph.retainedVersions() == 1);
+    }
+
+    SECTION("Conversion is a new version") {
+        const auto before = graph.snapshot();
+        REQUIRE(graph.convert<GraphAMatrix>() == 1);
+        REQUIRE(std::holds_alternative<GraphAMatrix>(graph.snapshot()->getVariant()));
+        REQUIRE(std::holds_alternative<GraphType>(before->getVariant()));
+    }
+
+    SECTION("Readers run while a writer publishes") {
+        // the writer only adds edges, so every reader sees a consistent graph with a non decreasing edge count
+        constexpr int num_batches = 50;
+        std::atomic<bool> done(false);
+        std::atomic<bool> consistent(true);
+        std::vector<std::jthread> readers;
+        for (int r = 0; r < 4; ++r) {
+            readers.emplace_back([&] {
+                int last_edges = 0;
+                while (!done.load()) {
+                    const auto snapshot = graph.snapshot();
+                    int degree_sum = 0;
+                    for (int u = 0; u < snapshot->numVertices(); ++u) {
+                        degree_sum += static_cast<int>(snapshot->outneighbors(u).size());
+                    }
+                    const int edges = snapshot->numEdges();
+                    if (degree_sum != edges || edges < last_edges ||
+                        edges != 3 + 2 * static_cast<int>(snapshot.getVersion())) {
+                        consistent.store(false);
+                    }
+                    last_edges = edges;
+                    Processor::TarjanUniversalSourceFinderStrategy().execute(*snapshot);
+                }
+            });
+        }
+        for (int i = 0; i < num_batches; ++i) {
+            EdgeBatch batch;
+            batch.add(i % 4, (i + 1) % 4);
+            batch.add(3, i % 4);
+            graph.apply(batch);
+        }
+        done.store(true);
+        readers.clear();
+        REQUIRE(consistent.load());
+        REQUIRE(graph.snapshot()->numEdges() == 3 + 2 * num_batches);
+        REQUIRE(graph.retainedVersions() == 1);
+    }
+}
+
+TEST_CASE("Versions do not copy stashed representations", "[snapshot]") {
+    constexpr int num_vertices = 1000;
+    CountingResource counting;
+    auto g = GraphFactory<ImplementedGraph>::createGraph<GraphNList>(num_vertices, &counting);
+    for (int u = 0; u + 1 < num_vertices; ++u) {
+        g->addEdge(u, u + 1);
+    }
+    VersionedGraph<ImplementedGraph> graph(std::move(*g));
+    const size_t list_bytes = counting.bytes_in_use();
+    graph.convert<GraphAMatrix>();
+    const size_t matrix_bytes = counting.bytes_in_use() - list_bytes;
+    // back to lists, the matrix stays stashed in the current version
+    graph.convert<GraphNList>();
+    const auto held = graph.snapshot();
+
+    // addEdge drops the stash of the new version again, a copied matrix would only show in the peak
+    const size_t before = counting.bytes_in_use();
+    counting.reset_peak();
+    EdgeBatch batch;
+    batch.add(0, 2);
+    graph.apply(batch);
+    const size_t next_version = counting.peak_bytes() - before;
+    REQUIRE(next_version <= list_bytes);
+    REQUIRE(next_version < matrix_bytes);
+    REQUIRE(std::holds_alternative<GraphNList>(graph.snapshot()->getVariant()));
+}
+
+TEST_CASE("Batches apply in place while no snapshot holds the version", "[snapshot]") {
+    constexpr int num_vertices = 1000;
+    CountingResource counting;
+    auto g = GraphFactory<ImplementedGraph>::createGraph<GraphNList>(num_vertices, &counting);
+    for (int u = 0; u + 1 < num_vertices; ++u) {
+        g->addEdge(u, u + 1);
+    }
+    VersionedGraph<ImplementedGraph> graph(std::move(*g));
+    const size_t list_bytes = counting.bytes_in_use();
+
+    SECTION("No snapshot held") {
+        counting.reset_peak();
+        EdgeBatch batch;
+        batch.add(0, 2);
+        batch.remove(0, 1);
+        REQUIRE(graph.apply(batch) == 1);
+        REQUIRE(counting.peak_bytes() < list_bytes + list_bytes / 10);
+        REQUIRE(graph.retainedVersions() == 1);
+        const auto snapshot = graph.snapshot();
+        REQUIRE(snapshot.getVersion() == 1);
+        REQUIRE(snapshot->has_edge(0, 2));
+        REQUIRE_FALSE(snapshot->has_edge(0, 1));
+    }
+
+    SECTION("A dropped snapshot does not keep the version shared") {
+        graph.snapshot();
+        counting.reset_peak();
+        EdgeBatch batch;
+        batch.add(0, 2);
+        graph.apply(batch);
+        REQUIRE(counting.peak_bytes() < list_bytes + list_bytes / 10);
+    }
+
+    SECTION("A held snapshot gets a copy") {
+        const auto held = graph.snapshot();
+        counting.reset_peak();
+        EdgeBatch batch;
+        batch.add(0, 2);
+        REQUIRE(graph.apply(batch) == 1);
+        REQUIRE(counting.peak_bytes() >= 2 * list_bytes);
+        REQUIRE_FALSE(held->has_edge(0, 2));
+        REQUIRE(held.getVersion() == 0);
+        REQUIRE(graph.snapshot()->has_edge(0, 2));
+    }
+
+    SECTION("An invalid vertex leaves the version unchanged") {
+        EdgeBatch batch;
+        batch.add(0, 2);
+        batch.add(0, num_vertices);
+        REQUIRE_THROWS_AS(graph.apply(batch), std::out_of_range);
+        REQUIRE_FALSE(graph.snapshot()->has_edge(0, 2));
+        REQUIRE(graph.snapshot().getVersion() == 0);
+    }
+
+    SECTION("Conversion in place") {
+        REQUIRE(graph.convert<GraphAMatrix>() == 1);
+        REQUIRE(graph.retainedVersions() == 1);
+        REQUIRE(std::holds_alternative<GraphAMatrix>(graph.snapshot()->getVariant()));
+        REQUIRE(graph.snapshot()->has_edge(0, 1));
+    }
+}